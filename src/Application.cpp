@@ -10,14 +10,202 @@
  */
 
 #include "Dictionary.h"
+#include "DictionaryHost.h"
+#include "ExportPipeline.h"
 #include "InteractiveDictionary.h"
 
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+/** The replay rates, in searches per second, that --qps takes. Slower
+ *  rates would not fit the time between searches. */
+static const double MIN_QUERIES_PER_SECOND = 0.001;
+static const long MAX_QUERIES_PER_SECOND = 1000000000;
+
+/** The largest memory budget, in megabytes, that --memory-budget takes. */
+static const std::size_t MAX_MEMORY_BUDGET = 1024 * 1024;
+
+/**
+ * @brief Reads a whole option value as a number, into value. Returns false
+ *        if it is not a number or is not above min and up to max.
+ */
+static bool readNumber(const char *text, double min, double max,
+                       double &value) {
+  char *end = nullptr;
+  value = std::strtod(text, &end);
+  return end != text && *end == '\0' && value > min && value <= max;
+}
+
 /**
  * @brief Use the interactive dictionary.
+ *        Options:
+ *          --memory-report   print the memory used by each part of the
+ *                            dictionary after the last search
+ *          --record <log>    append every search to a session log
+ *          --replay <log>    replay the searches of a session log and
+ *                            print their latencies, instead of reading
+ *                            searches
+ *          --qps <number>    replay at a fixed number of searches per
+ *                            second, instead of as fast as possible
+ *          --qps recorded    replay each search as long after the one
+ *                            before it as when it was recorded
+ *          --export <format> write every sense to a file as jsonl, tsv
+ *                            or csv, instead of reading searches
+ *          --output <file>   the file to export to
+ *          --threads <n>     the number of threads formatting the export,
+ *                            from 1 to 256
+ *          --lookup-batch <file>
+ *                            print how many entries each word of a file
+ *                            has, looking the words up in batches, instead
+ *                            of reading searches
+ *          --dictionary <name>=<file>
+ *                            host the data file under a name; searches
+ *                            select it with '@name'. Can be repeated.
+ *          --memory-budget <megabytes>
+ *                            evict the least recently used hosted
+ *                            dictionaries to stay within this budget
  */
-int main() {
+int main(int argc, char *argv[]) {
+  bool shouldReportMemory = false;
+  std::string recordPath;
+  std::string replayPath;
+  double queriesPerSecond = 0;
+  bool isRecordedPace = false;
+  std::string exportFormat;
+  std::string exportPath;
+  unsigned exportThreads = std::thread::hardware_concurrency();
+  std::string lookupPath;
+  std::vector<std::string> hostedDictionaries;
+  std::size_t memoryBudget = DictionaryHost::NO_BUDGET;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--memory-report") == 0) {
+      shouldReportMemory = true;
+    } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+      recordPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+      replayPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--qps") == 0 && hasValue) {
+      ++i;
+      isRecordedPace = std::strcmp(argv[i], "recorded") == 0;
+      if (!isRecordedPace &&
+          !readNumber(argv[i], MIN_QUERIES_PER_SECOND, MAX_QUERIES_PER_SECOND,
+                      queriesPerSecond)) {
+        std::cout << "<!>ERROR<!> ===> --qps must be 'recorded', or above "
+                  << MIN_QUERIES_PER_SECOND << " and up to "
+                  << MAX_QUERIES_PER_SECOND << "\n";
+        return 1;
+      }
+    } else if (std::strcmp(argv[i], "--export") == 0 && hasValue) {
+      exportFormat = argv[++i];
+    } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+      exportPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+      int threads = std::atoi(argv[++i]);
+      if (threads < 1 || threads > int{ExportPipeline::MAX_THREADS}) {
+        std::cout << "<!>ERROR<!> ===> --threads must be from 1 to "
+                  << ExportPipeline::MAX_THREADS << "\n";
+        return 1;
+      }
+      exportThreads = threads;
+    } else if (std::strcmp(argv[i], "--lookup-batch") == 0 && hasValue) {
+      lookupPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--dictionary") == 0 && hasValue) {
+      hostedDictionaries.push_back(argv[++i]);
+    } else if (std::strcmp(argv[i], "--memory-budget") == 0 && hasValue) {
+      double megabytes = 0;
+      if (!readNumber(argv[++i], 0, MAX_MEMORY_BUDGET, megabytes)) {
+        std::cout << "<!>ERROR<!> ===> --memory-budget must be above 0 and "
+                     "up to "
+                  << MAX_MEMORY_BUDGET << " megabytes\n";
+        return 1;
+      }
+      memoryBudget = static_cast<std::size_t>(megabytes * 1024 * 1024);
+    } else {
+      std::cout << "<!>ERROR<!> ===> Unknown option: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  Dictionary::ExportFormat format = Dictionary::ExportFormat::JSONL;
+  if (!exportFormat.empty()) {
+    if (exportFormat == "tsv") {
+      format = Dictionary::ExportFormat::TSV;
+    } else if (exportFormat == "csv") {
+      format = Dictionary::ExportFormat::CSV;
+    } else if (exportFormat != "jsonl") {
+      std::cout << "<!>ERROR<!> ===> Unknown export format: " << exportFormat
+                << "\n";
+      return 1;
+    }
+    if (exportPath.empty()) {
+      std::cout << "<!>ERROR<!> ===> Export needs an --output file\n";
+      return 1;
+    }
+  }
+
+  if (!hostedDictionaries.empty()) {
+    if (!exportFormat.empty() || !lookupPath.empty() || !replayPath.empty() ||
+        !recordPath.empty()) {
+      std::cout << "<!>ERROR<!> ===> --dictionary cannot be used with "
+                   "--export, --lookup-batch, --record or --replay\n";
+      return 1;
+    }
+    DictionaryHost host(memoryBudget);
+    for (std::string &hosted : hostedDictionaries) {
+      std::size_t separator = hosted.find('=');
+      if (separator == std::string::npos ||
+          !host.registerDictionary(hosted.substr(0, separator),
+                                   hosted.substr(separator + 1))) {
+        std::cout << "<!>ERROR<!> ===> Expected a new <name>=<file>: "
+                  << hosted << "\n";
+        return 1;
+      }
+    }
+    host.read();
+    if (shouldReportMemory) {
+      host.printMetrics(std::cout);
+    }
+    return 0;
+  }
+
   InteractiveDictionary InteractiveDictionary;
-  InteractiveDictionary.read();
+  if (!lookupPath.empty()) {
+    std::ifstream words(lookupPath);
+    if (!words.is_open()) {
+      std::cout << "<!>ERROR<!> ===> Word list could not be opened: "
+                << lookupPath << "\n";
+      return 1;
+    }
+    InteractiveDictionary.populateWithData();
+    InteractiveDictionary.lookupBatch(words);
+  } else if (!exportFormat.empty()) {
+    InteractiveDictionary.populateWithData();
+    if (!InteractiveDictionary.exportData(format, exportPath, exportThreads)) {
+      return 1;
+    }
+  } else if (!replayPath.empty()) {
+    std::vector<RecordedQuery> queries;
+    if (!loadSessionLog(replayPath, queries)) {
+      std::cout << "<!>ERROR<!> ===> Session log could not be opened: "
+                << replayPath << "\n";
+      return 1;
+    }
+    InteractiveDictionary.replay(queries, queriesPerSecond, isRecordedPace);
+  } else {
+    if (!recordPath.empty() &&
+        !InteractiveDictionary.recordSession(recordPath)) {
+      std::cout << "<!>ERROR<!> ===> Session log could not be opened: "
+                << recordPath << "\n";
+      return 1;
+    }
+    InteractiveDictionary.read();
+  }
+
+  if (shouldReportMemory) {
+    InteractiveDictionary.printMemoryReport(std::cout);
+  }
 
   return 0;
 }
@@ -0,0 +1,470 @@
+/**
+ * File:        Benchmark.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file measures how fast the parts of the dictionary run
+ *  on large, generated data.
+ */
+
+#include "CycleVector.h"
+#include "Dictionary.h"
+#include "LineParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using std::cout;
+using std::ifstream;
+using std::istringstream;
+using std::map;
+using std::string;
+using std::vector;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Returns the seconds passed since a given time.
+ */
+static double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Returns the lines of a data file repeated until there are at least
+ *        the given number of lines. Repeated words get a number appended so
+ *        every repetition adds new keywords.
+ */
+static string makeData(const string &path, size_t lineCount) {
+  ifstream inFile(path);
+  vector<string> lines;
+  string line;
+  while (getline(inFile, line)) {
+    lines.push_back(line);
+  }
+  if (lines.empty()) {
+    cout << "<!>ERROR<!> ===> File could not be opened: " << path << "\n";
+    std::exit(1);
+  }
+
+  string data;
+  for (size_t i = 0; i < lineCount; i++) {
+    const string &source = lines.at(i % lines.size());
+    size_t wordEnd = source.find('|');
+    wordEnd = (wordEnd == string::npos) ? source.size() : wordEnd;
+    data += source.substr(0, wordEnd);
+    if (i >= lines.size()) {
+      data += std::to_string(i / lines.size());
+    }
+    data += source.substr(wordEnd);
+    data += '\n';
+  }
+  return data;
+}
+
+static void printResult(const string &name, double seconds, size_t lines,
+                        size_t bytes) {
+  cout << "        " << name << " : " << seconds * 1000 << " ms, "
+       << lines / seconds / 1000000 << " M lines/s, "
+       << bytes / seconds / 1000000 << " MB/s\n";
+}
+
+/** ---START:---- LINE PARSER BENCHMARK ------------------------- */
+
+/**
+ * @brief   The parser the dictionary used before the table-driven one:
+ *          it cycles between delimiter strings with a CycleVector and
+ *          tidies every line and definition with regular expressions.
+ */
+class LegacyParser {
+public:
+  struct Sense {
+    string partOfSpeech;
+    string definition;
+  };
+
+  map<string, vector<Sense>> entries;
+
+  void parse(istringstream &inFile) {
+    CycleVector delimiter(PRE_PART_OF_SPEECH_DELIMITER,
+                          PRE_DEFINITION_DELIMITER);
+    string lineContent;
+    while (getline(inFile, lineContent)) {
+      lineContent.erase(
+          std::remove(lineContent.begin(), lineContent.end(), '\r'),
+          lineContent.end());
+      trim(lineContent);
+      istringstream iss{lineContent};
+      string content;
+      string partOfSpeech;
+      string definition;
+      string word = lineContent.substr(
+          0, lineContent.find(PRE_PART_OF_SPEECH_DELIMITER));
+      word[0] = toupper(word[0]);
+      delimiter.reset();
+
+      while (!iss.eof()) {
+        string validDelimiter = delimiter.check();
+        iss >> content;
+        if (content.find(validDelimiter) != string::npos) {
+          if (validDelimiter == PRE_PART_OF_SPEECH_DELIMITER) {
+            if (delimiter.getCycles() != 0) {
+              definition +=
+                  ' ' + content.substr(0, content.find(validDelimiter));
+              trim(definition);
+              definition[0] = toupper(definition[0]);
+              add(word, partOfSpeech, definition);
+              definition.clear();
+            }
+            partOfSpeech = content.substr(content.find(validDelimiter) + 1);
+            partOfSpeech[0] = tolower(partOfSpeech[0]);
+            validDelimiter = delimiter.cycle();
+            continue;
+          }
+          if (content == PRE_DEFINITION_DELIMITER) {
+            validDelimiter = delimiter.cycle();
+            continue;
+          }
+        }
+        definition += ' ' + content;
+      }
+      trim(definition);
+      add(word, partOfSpeech, definition);
+    }
+  }
+
+private:
+  string PRE_DEFINITION_DELIMITER{"-=>>"};
+  string PRE_PART_OF_SPEECH_DELIMITER{"|"};
+
+  void trim(string &content) {
+    content = std::regex_replace(content, std::regex("^ +| +$|( ) +"), "$1");
+  }
+
+  void add(string &word, string &partOfSpeech, string &definition) {
+    string standardizedDefinition = std::regex_replace(
+        definition, std::regex("\\.\\.\\s*$"), ".");
+    entries[word].push_back(Sense{partOfSpeech, standardizedDefinition});
+  }
+};
+
+/**
+ * @brief   A sink that only counts what a LineParser finds, for
+ *          measuring the parser alone.
+ */
+struct CountingSink {
+  size_t senses{0};
+  size_t bytes{0};
+
+  void word(const char *, size_t length) { bytes += length; }
+  void sense(const string &partOfSpeech, const string &definition, bool) {
+    ++senses;
+    bytes += partOfSpeech.size() + definition.size();
+  }
+};
+
+/**
+ * @brief   An alternate data file format, such as
+ *              book#noun :: A set of pages.
+ */
+struct HashLineGrammar {
+  static constexpr char prePartOfSpeechDelimiter() { return '#'; }
+  static constexpr const char *preDefinitionDelimiter() { return "::"; }
+};
+
+/**
+ * @brief   Loads data the way the dictionary does, and checks that the
+ *          entries match the ones the legacy parser made.
+ */
+class ParserBenchmark : public Dictionary {
+public:
+  void parse(istringstream &inFile) { parseData(inFile, entriesBatch); }
+
+  bool matches(const map<string, vector<LegacyParser::Sense>> &legacy) {
+    if (legacy.size() != entriesBatch.size()) {
+      return false;
+    }
+    for (const auto &keywordEntries : entriesBatch) {
+      auto legacyEntries = legacy.find(
+          string(keywordEntries.first.begin(), keywordEntries.first.end()));
+      if (legacyEntries == legacy.end() ||
+          legacyEntries->second.size() != keywordEntries.second.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < keywordEntries.second.size(); i++) {
+        const Entry &entry = keywordEntries.second.at(i);
+        const LegacyParser::Sense &sense = legacyEntries->second.at(i);
+        if (sense.partOfSpeech != entry.partOfSpeech.c_str() ||
+            sense.definition != entry.definition.c_str()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+static void benchmarkLineParser(const string &data, size_t lineCount) {
+  cout << "------ Line parser (" << lineCount << " lines)\n";
+
+  istringstream legacyInput(data);
+  LegacyParser legacy;
+  Clock::time_point start = Clock::now();
+  legacy.parse(legacyInput);
+  printResult("legacy parser  ", secondsSince(start), lineCount, data.size());
+
+  istringstream input(data);
+  ParserBenchmark dictionary;
+  start = Clock::now();
+  dictionary.parse(input);
+  printResult("load entries   ", secondsSince(start), lineCount, data.size());
+
+  istringstream lines(data);
+  LineParser<DefaultLineGrammar> parser;
+  CountingSink sink;
+  string line;
+  start = Clock::now();
+  while (getline(lines, line)) {
+    parser.parse(line, sink);
+  }
+  printResult("parse only     ", secondsSince(start), lineCount, data.size());
+
+  string alternateData = data;
+  for (size_t i = 0; i < alternateData.size(); i++) {
+    if (alternateData[i] == '|') {
+      alternateData[i] = '#';
+    } else if (alternateData.compare(i, 4, "-=>>") == 0) {
+      alternateData.replace(i, 4, "::");
+    }
+  }
+  istringstream alternateLines(alternateData);
+  LineParser<HashLineGrammar> alternateParser;
+  CountingSink alternateSink;
+  start = Clock::now();
+  while (getline(alternateLines, line)) {
+    alternateParser.parse(line, alternateSink);
+  }
+  printResult("parse '#' '::' ", secondsSince(start), lineCount,
+              alternateData.size());
+
+  cout << "        entries match legacy parser: "
+       << (dictionary.matches(legacy.entries) ? "yes" : "NO") << "\n";
+  cout << "        senses found by both grammars: "
+       << ((sink.senses == alternateSink.senses) ? "equal" : "DIFFERENT")
+       << "\n";
+}
+
+/** ---END:------ LINE PARSER BENCHMARK ------------------------- */
+
+/** ---START:---- PATTERN SEARCH BENCHMARK ------------------------- */
+
+/**
+ * @brief   A dictionary whose keyword patterns can be searched through
+ *          the index or by checking every keyword.
+ */
+class PatternBenchmark : public Dictionary {
+public:
+  void load(const string &data) {
+    istringstream input(data);
+    parseData(input, entriesBatch);
+  }
+
+  size_t countIndexed(const AccountedString &pattern) {
+    KeywordPatternIndex::Keywords matches;
+    keywordPatterns.match(pattern, matches);
+    return matches.size();
+  }
+
+  /**
+   * @brief Counts the keywords matching a pattern by checking each one,
+   *        with both spelled in lower case, as the index ignores case.
+   */
+  size_t countBruteForce(const AccountedString &pattern) {
+    AccountedString lowerCasePattern(pattern);
+    lowerCaseAllLettersOf(lowerCasePattern);
+    AccountedString lowerCaseKeyword;
+    size_t count = 0;
+    for (const auto &keywordEntries : entriesBatch) {
+      lowerCaseKeyword = keywordEntries.first;
+      lowerCaseAllLettersOf(lowerCaseKeyword);
+      if (KeywordPatternIndex::matchesPattern(lowerCaseKeyword,
+                                              lowerCasePattern)) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  size_t getCandidateCount(const AccountedString &pattern) {
+    return keywordPatterns.getCandidateCount(pattern);
+  }
+
+  size_t getKeywordCount() { return entriesBatch.size(); }
+};
+
+static void benchmarkPatternSearch(const string &data) {
+  PatternBenchmark dictionary;
+  dictionary.load(data);
+  cout << "------ Pattern search (" << dictionary.getKeywordCount()
+       << " keywords)\n";
+
+  const char *patterns[] = {"B??k*",  "*binder*", "*binder7", "Csc34*",
+                            "*ook*12?", "?e*",    "*",        "*book*",
+                            "*Book*",   "book*",  "*ook",     "?OOK*"};
+  const int repetitions = 20;
+  for (const char *text : patterns) {
+    AccountedString pattern(text);
+    size_t indexedMatches = 0;
+    size_t bruteForceMatches = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < repetitions; i++) {
+      indexedMatches = dictionary.countIndexed(pattern);
+    }
+    double indexedSeconds = secondsSince(start) / repetitions;
+
+    start = Clock::now();
+    for (int i = 0; i < repetitions; i++) {
+      bruteForceMatches = dictionary.countBruteForce(pattern);
+    }
+    double bruteForceSeconds = secondsSince(start) / repetitions;
+
+    cout << "        " << text << " : " << indexedMatches << " matches, "
+         << dictionary.getCandidateCount(pattern) << " candidates, indexed "
+         << indexedSeconds * 1e6 << " us, brute force "
+         << bruteForceSeconds * 1e6 << " us"
+         << ((indexedMatches == bruteForceMatches) ? "" : " <MISMATCH>")
+         << "\n";
+  }
+}
+
+/** ---END:------ PATTERN SEARCH BENCHMARK ------------------------- */
+
+/** ---START:---- BATCH LOOKUP BENCHMARK ------------------------- */
+
+/**
+ * @brief   A dictionary whose keywords can be looked up in its map, one at
+ *          a time in its hash index, or in batches in its hash index. Each
+ *          lookup reads the first entry found, as printing it would.
+ */
+class LookupBenchmark : public Dictionary {
+public:
+  void load(const string &data) {
+    istringstream input(data);
+    parseData(input, entriesBatch);
+  }
+
+  vector<AccountedString> getKeywords() {
+    vector<AccountedString> keywords;
+    for (const auto &storedEntries : entriesBatch) {
+      keywords.push_back(storedEntries.first);
+    }
+    return keywords;
+  }
+
+  size_t lookUpInMap(const vector<AccountedString> &keywords) {
+    size_t found = 0;
+    for (const AccountedString &keyword : keywords) {
+      EntriesBatch::const_iterator storedEntries = entriesBatch.find(keyword);
+      if (storedEntries != entriesBatch.end()) {
+        found += storedEntries->second.front().definition.size();
+      }
+    }
+    return found;
+  }
+
+  size_t lookUpOneAtATime(const vector<AccountedString> &keywords) {
+    size_t found = 0;
+    for (const AccountedString &keyword : keywords) {
+      const Entries *entries = keywordEntries.find(keyword);
+      if (entries != nullptr) {
+        found += entries->front().definition.size();
+      }
+    }
+    return found;
+  }
+
+  size_t lookUpInBatches(const vector<AccountedString> &keywords) {
+    const size_t batchSize = 256;
+    const Entries *entries[batchSize];
+    size_t found = 0;
+    for (size_t first = 0; first < keywords.size(); first += batchSize) {
+      size_t count = std::min(batchSize, keywords.size() - first);
+      // What findEntries() does, so that it is built with this file's -O2
+      // like the other methods; Dictionary.o is not optimized.
+      keywordEntries.findBatch(&keywords[first], count, entries);
+      for (size_t i = 0; i < count; i++) {
+        if (entries[i] != nullptr) {
+          prefetchForRead(entries[i]->data());
+        }
+      }
+      for (size_t i = 0; i < count; i++) {
+        if (entries[i] != nullptr) {
+          found += entries[i]->front().definition.size();
+        }
+      }
+    }
+    return found;
+  }
+};
+
+static void benchmarkBatchLookup(const string &data) {
+  LookupBenchmark dictionary;
+  dictionary.load(data);
+
+  // Look up every keyword twice, in random order, with one in ten missing.
+  vector<AccountedString> keywords = dictionary.getKeywords();
+  size_t keywordCount = keywords.size();
+  for (size_t i = 0; i < keywordCount; i++) {
+    keywords.push_back(keywords[i]);
+    if (i % 5 == 0) {
+      keywords.back() += "~";
+    }
+  }
+  std::shuffle(keywords.begin(), keywords.end(), std::mt19937(340));
+  cout << "------ Batch lookup (" << keywordCount << " keywords, "
+       << keywords.size() << " lookups)\n";
+
+  struct Method {
+    const char *name;
+    size_t (LookupBenchmark::*lookUp)(const vector<AccountedString> &);
+  };
+  const Method methods[] = {
+      {"map, one at a time  ", &LookupBenchmark::lookUpInMap},
+      {"hash, one at a time ", &LookupBenchmark::lookUpOneAtATime},
+      {"hash, batched       ", &LookupBenchmark::lookUpInBatches}};
+  size_t expected = dictionary.lookUpInMap(keywords);
+  for (const Method &method : methods) {
+    Clock::time_point start = Clock::now();
+    size_t found = (dictionary.*method.lookUp)(keywords);
+    double seconds = secondsSince(start);
+    cout << "        " << method.name << " : " << seconds * 1000 << " ms, "
+         << keywords.size() / seconds / 1000000 << " M lookups/s"
+         << ((found == expected) ? "" : " <MISMATCH>") << "\n";
+  }
+}
+
+/** ---END:------ BATCH LOOKUP BENCHMARK ------------------------- */
+
+/**
+ * @brief Runs every benchmark on data generated from a data file.
+ *        Usage: Benchmark [data file] [number of lines]
+ */
+int main(int argc, char *argv[]) {
+  string path = (argc > 1) ? argv[1] : "data/v.txt";
+  size_t lineCount = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20000;
+
+  string data = makeData(path, lineCount);
+  cout << "====== BENCHMARK =====\n";
+  benchmarkLineParser(data, lineCount);
+  benchmarkPatternSearch(data);
+  // Lookups only stop fitting in the caches with many more keywords.
+  benchmarkBatchLookup(makeData(path, lineCount * 10));
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * File:        BloomFilter.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  of a filter that can quickly tell that a keyword is NOT
+ *  in a dictionary.
+ */
+
+#include "BloomFilter.h"
+#include "KeywordHash.h"
+
+#include <cstring>
+
+using std::size_t;
+using std::uint64_t;
+
+/**
+ * @brief Constructs a filter with a single block, taking its memory
+ *        from the given resource.
+ */
+BloomFilter::BloomFilter(MemoryResource *resource)
+    : blocks(AccountingAllocator<Block>(resource)) {
+  reserve(0);
+}
+
+/**
+ * @brief Clears this filter and sizes it for the expected number of
+ *        keywords, which keeps false positives around one percent.
+ */
+void BloomFilter::reserve(size_t expectedKeywords) {
+  size_t blockCount =
+      (expectedKeywords * BITS_PER_KEYWORD + BITS_PER_BLOCK - 1) /
+      BITS_PER_BLOCK;
+  blocks.assign((blockCount == 0) ? 1 : blockCount, Block());
+  for (Block &block : blocks) {
+    std::memset(block.words, 0, sizeof(block.words));
+  }
+}
+
+/**
+ * @brief Sets the bits of a keyword. Each 9-bit slice of the remixed
+ *        hash picks one bit inside the keyword's block.
+ */
+void BloomFilter::add(const char *keyword, size_t length) {
+  uint64_t hash = hashKeyword(keyword, length);
+  Block &block = blockOf(hash);
+  uint64_t bitHash = remix(hash);
+  for (int i = 0; i < HASHES_PER_KEYWORD; i++) {
+    uint64_t bit = (bitHash >> (9 * i)) & (BITS_PER_BLOCK - 1);
+    block.words[bit / 64] |= (uint64_t{1} << (bit % 64));
+  }
+}
+
+/**
+ * @brief Returns false if the keyword was definitely never added.
+ */
+bool BloomFilter::mightContain(const char *keyword, size_t length) const {
+  uint64_t hash = hashKeyword(keyword, length);
+  const Block &block = blockOf(hash);
+  uint64_t bitHash = remix(hash);
+  for (int i = 0; i < HASHES_PER_KEYWORD; i++) {
+    uint64_t bit = (bitHash >> (9 * i)) & (BITS_PER_BLOCK - 1);
+    if (!(block.words[bit / 64] & (uint64_t{1} << (bit % 64)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t BloomFilter::sizeInBytes() const {
+  return blocks.size() * sizeof(Block);
+}
+
+/**
+ * @brief Returns the block a hash belongs to, chosen by its upper half.
+ */
+BloomFilter::Block &BloomFilter::blockOf(uint64_t hash) {
+  return blocks[(hash >> 32) % blocks.size()];
+}
+
+const BloomFilter::Block &BloomFilter::blockOf(uint64_t hash) const {
+  return blocks[(hash >> 32) % blocks.size()];
+}
+
+/**
+ * @brief Derives the bit-picking hash from the keyword's hash so that it
+ *        is unrelated to the choice of block.
+ */
+uint64_t BloomFilter::remix(uint64_t hash) {
+  hash *= 0x9e3779b97f4a7c15ULL;
+  return hash ^ (hash >> 29);
+}
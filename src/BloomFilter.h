@@ -0,0 +1,56 @@
+/**
+ * File:        BloomFilter.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  of a filter that can quickly tell that a keyword is NOT
+ *  in a dictionary.
+ */
+
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MemoryAccounting.h"
+
+/**
+ * @brief   A blocked Bloom filter: every keyword sets all of its bits inside
+ *          one 64-byte block, so a lookup touches a single cache line.
+ *          It may wrongly say a keyword is present, but never wrongly
+ *          says that it is absent.
+ */
+class BloomFilter {
+public:
+  explicit BloomFilter(
+      MemoryResource *resource = MemoryResource::defaultResource());
+
+  void reserve(std::size_t expectedKeywords);
+  void add(const char *keyword, std::size_t length);
+  bool mightContain(const char *keyword, std::size_t length) const;
+
+  std::size_t sizeInBytes() const;
+
+private:
+  static const int BITS_PER_KEYWORD = 12;
+  static const int BITS_PER_BLOCK = 512;
+  static const int HASHES_PER_KEYWORD = 7;
+
+  struct Block {
+    std::uint64_t words[BITS_PER_BLOCK / 64];
+  };
+
+  std::vector<Block, AccountingAllocator<Block>> blocks;
+
+  Block &blockOf(std::uint64_t hash);
+  const Block &blockOf(std::uint64_t hash) const;
+  static std::uint64_t remix(std::uint64_t hash);
+};
+
+#endif // BLOOMFILTER_H
@@ -12,21 +12,42 @@
  */
 
 #include "Dictionary.h"
-#include "CycleVector.h"
+#include "ExportPipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 
 using std::cin;
 using std::cout;
 using std::ifstream;
 using std::ios;
+using std::istream;
 using std::istringstream;
 using std::map;
 using std::ostringstream;
+using std::size_t;
 using std::smatch;
 using std::string;
 using std::stringstream;
 using std::toupper;
 using std::vector;
 
+/**
+ * @brief Constructs an empty dictionary whose entries are accounted as
+ *        storage memory.
+ */
+Dictionary::Dictionary()
+    : entriesBatch(EntriesBatch::allocator_type(&storageMemory)),
+      keywordFilter(&storageMemory), keywordPatterns(&storageMemory),
+      keywordEntries(&storageMemory) {}
+
+/**
+ * @brief Waits for a running compaction, so that its data file is
+ *        complete.
+ */
+Dictionary::~Dictionary() { finishCompaction(true); }
+
 /**
  * @brief Populate this dictionary with entries (words, part of speeches,
  *        and definitions) from a file.
@@ -36,6 +57,20 @@ void Dictionary::populateWithData() {
   cin.ignore();
 }
 
+/**
+ * @brief Loads entries from the file at the given path without asking for
+ *        it or printing anything. Returns false if it could not be opened.
+ */
+bool Dictionary::loadFromFile(const string &filePath) {
+  ifstream inFile(filePath);
+  if (!inFile.is_open()) {
+    return false;
+  }
+  parseData(inFile, entriesBatch);
+  openEditLog(filePath);
+  return true;
+}
+
 /**
  * @brief Loads entries (words, part of speeches, and definitions) into this
  *        dictionary from a file.
@@ -47,59 +82,418 @@ void Dictionary::loadData(string filePath) {
   cout << "! Loading data..."
        << "\n";
   parseData(inFile, entriesBatch);
+  inFile.close();
+  openEditLog(filePath);
 
   printLoadedDataPrompt(filePath);
 }
 
+/**
+ * @brief Hands the words and senses found by the line parser to a
+ *        dictionary as new entries.
+ */
+struct Dictionary::EntryCollector {
+  Dictionary &dictionary;
+  EntriesBatch &entries;
+  AccountedString keyword;
+  AccountedString partOfSpeech;
+  AccountedString definition;
+
+  void word(const char *word, size_t length) {
+    keyword.assign(word, length);
+    dictionary.capitalizeFirstLetterOf(keyword);
+  }
+
+  void sense(const AccountedString &parsedPartOfSpeech,
+             const AccountedString &parsedDefinition, bool closedByNextSense) {
+    partOfSpeech = parsedPartOfSpeech;
+    dictionary.lowerCaseFirstLetterOf(partOfSpeech);
+    definition = parsedDefinition;
+    if (closedByNextSense) {
+      dictionary.capitalizeFirstLetterOf(definition);
+    }
+    dictionary.makeNewEntry(entries, keyword, partOfSpeech, definition);
+  }
+};
+
 /**
  * @brief Understand and gets the word-part, part of speech-part,
- *        and definition-part of a file's content.
+ *        and definition-part of a file's content. Everything used only
+ *        while parsing is accounted as parse memory.
  */
-void Dictionary::parseData(ifstream &inFile,
-                           map<string, vector<Entry>> &entries) {
-  CycleVector delimiter(PRE_PART_OF_SPEECH_DELIMITER, PRE_DEFINITION_DELIMITER);
-  string lineContent;
-  std::cout << "lineConente=" << lineContent << std::endl;
+void Dictionary::parseData(istream &inFile, EntriesBatch &entries) {
+  AccountingAllocator<char> parseAllocator(&parseMemory);
+  LineParser<DefaultLineGrammar, AccountingAllocator<char>> lineParser(
+      parseAllocator);
+  EntryCollector collector{*this, entries, AccountedString(parseAllocator),
+                           AccountedString(parseAllocator),
+                           AccountedString(parseAllocator)};
+  AccountedString lineContent(parseAllocator);
   while (getline(inFile, lineContent)) {
-    eraseCarriageReturnsOf(lineContent);
-    eraseLeadingAndTrailingWhiteSpacesOf(lineContent);
-    istringstream iss{lineContent};
-    string content;
-    ;
-    string word;
-    string partOfSpeech;
-    string definition;
-    word = getWordPartOf(lineContent, PRE_PART_OF_SPEECH_DELIMITER);
-    delimiter.reset();
-
-    while (!iss.eof()) {
-      string validDelimiter = delimiter.check();
-      iss >> content;
-      if (hasDelimiter(content, validDelimiter)) {
-        if (validDelimiter == PRE_PART_OF_SPEECH_DELIMITER) {
-          if (delimiter.getCycles() != 0) {
-            definition += ' ' + getDefinitionPartOf(content, validDelimiter);
-            eraseLeadingAndTrailingWhiteSpacesOf(definition);
-            capitalizeFirstLetterOf(definition);
-            makeNewEntry(entries, word, partOfSpeech, definition);
-            definition.clear();
-          }
-          partOfSpeech = getPartOfSpeechPartOf(content, validDelimiter);
-          validDelimiter = delimiter.cycle();
-          continue;
-        }
-        if (content == PRE_DEFINITION_DELIMITER) {
-          validDelimiter = delimiter.cycle();
-          continue;
-        }
+    lineParser.parse(lineContent, collector);
+  }
+  uniqueKeywords = entries.size();
+  buildKeywordIndexes();
+}
+
+/**
+ * @brief Calls visit with each entry shown for a keyword, stopping early
+ *        if it returns false: the stored entries, then the senses added
+ *        while compacting, then the ones added since, leaving out every
+ *        sense deleted after it was added.
+ */
+template <typename Visit>
+void Dictionary::visitEntries(const AccountedString &keyword,
+                              const Entries *storedEntries, Visit visit) {
+  const Entries *compactingAdded = findEdits(compactingEdits.added, keyword);
+  const Entries *compactingDeleted =
+      findEdits(compactingEdits.deleted, keyword);
+  const Entries *activeAdded = findEdits(activeEdits.added, keyword);
+  const Entries *activeDeleted = findEdits(activeEdits.deleted, keyword);
+
+  if (storedEntries != nullptr) {
+    for (const Entry &entry : *storedEntries) {
+      if (!containsSense(compactingDeleted, entry) &&
+          !containsSense(activeDeleted, entry) && !visit(entry)) {
+        return;
       }
-      definition += ' ' + content;
     }
-    eraseLeadingAndTrailingWhiteSpacesOf(definition);
-    makeNewEntry(entries, word, partOfSpeech, definition);
   }
-  uniqueKeywords = entries.size();
-  inFile.close();
+  if (compactingAdded != nullptr) {
+    for (const Entry &entry : *compactingAdded) {
+      if (!containsSense(activeDeleted, entry) && !visit(entry)) {
+        return;
+      }
+    }
+  }
+  if (activeAdded != nullptr) {
+    for (const Entry &entry : *activeAdded) {
+      if (!visit(entry)) {
+        return;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Returns true if any entry is shown for a keyword.
+ */
+bool Dictionary::hasEntries(const AccountedString &keyword) {
+  bool hasEntry = false;
+  visitEntries(keyword, keywordEntries.find(keyword),
+               [&hasEntry](const Entry &) {
+                 hasEntry = true;
+                 return false;
+               });
+  return hasEntry;
+}
+
+/**
+ * @brief Adds a view of each entry shown for a keyword to views.
+ */
+void Dictionary::collectEntries(const AccountedString &keyword,
+                                EntryViews &views) {
+  const Entries *storedEntries = keywordEntries.find(keyword);
+  if (storedEntries != nullptr) {
+    views.reserve(storedEntries->size());
+  }
+  visitEntries(keyword, storedEntries, [&views](const Entry &entry) {
+    views.push_back(&entry);
+    return true;
+  });
+}
+
+/**
+ * @brief Returns the number of entries shown for a keyword whose stored
+ *        entries were already found.
+ */
+size_t Dictionary::countEntries(const AccountedString &keyword,
+                                const Entries *storedEntries) {
+  if (activeEdits.count == 0 && compactingEdits.count == 0) {
+    return (storedEntries == nullptr) ? 0 : storedEntries->size();
+  }
+  size_t count = 0;
+  visitEntries(keyword, storedEntries, [&count](const Entry &) {
+    ++count;
+    return true;
+  });
+  return count;
+}
+
+/**
+ * @brief Puts the keywords with shown entries that match a pattern into
+ *        matches, in sorted order. Keywords that only have added senses
+ *        are not in the index, and are checked one by one. Stored
+ *        keywords whose senses were all deleted stay in the index, and
+ *        are left out here.
+ */
+void Dictionary::matchKeywords(const AccountedString &pattern,
+                               KeywordPatternIndex::Keywords &matches) {
+  keywordPatterns.match(pattern, matches);
+  bool hasEmptyKeywords =
+      entriesBatch.size() != static_cast<size_t>(uniqueKeywords);
+  if (activeEdits.count == 0 && compactingEdits.count == 0 &&
+      !hasEmptyKeywords) {
+    return;
+  }
+
+  matches.erase(std::remove_if(matches.begin(), matches.end(),
+                               [this](const AccountedString *keyword) {
+                                 return !hasEntries(*keyword);
+                               }),
+                matches.end());
+  size_t indexedMatches = matches.size();
+  for (const EntriesBatch *added :
+       {&compactingEdits.added, &activeEdits.added}) {
+    for (const auto &addedEntries : *added) {
+      const AccountedString &keyword = addedEntries.first;
+      if (keywordEntries.find(keyword) == nullptr &&
+          KeywordPatternIndex::matchesPattern(keyword, pattern) &&
+          hasEntries(keyword) &&
+          std::find_if(matches.begin() + indexedMatches, matches.end(),
+                       [&keyword](const AccountedString *match) {
+                         return *match == keyword;
+                       }) == matches.end()) {
+        matches.push_back(&keyword);
+      }
+    }
+  }
+  std::sort(matches.begin(), matches.end(),
+            [](const AccountedString *keyword1,
+               const AccountedString *keyword2) {
+              return KeywordPatternIndex::isSortedBefore(*keyword1,
+                                                         *keyword2);
+            });
+}
+
+/**
+ * @brief Adds one copy of a sense to a keyword unless it is already
+ *        shown, and logs it. The keyword and definition are standardized
+ *        as if they were loaded. Returns false if nothing changed.
+ */
+bool Dictionary::addSense(AccountedString &keyword,
+                          AccountedString &partOfSpeech,
+                          AccountedString &definition) {
+  standardizeKeyword(keyword);
+  capitalizeFirstLetterOf(definition);
+  Entry entry = makeEntry(keyword, partOfSpeech, definition);
+  definition = entry.definition;
+  if (isShown(keyword, entry)) {
+    return false;
+  }
+
+  // A deleted sense stays deleted, so that adding it back shows one copy
+  // of it, as replaying the log and compacting do, and not every copy
+  // that was stored.
+  logEdit('+', keyword, entry);
+  editsOf(activeEdits.added, keyword).push_back(std::move(entry));
+  ++activeEdits.count;
+  keywordFilter.add(keyword.data(), keyword.size());
+  definitions += 1;
+  compactIfNeeded();
+  return true;
+}
+
+/**
+ * @brief Deletes the shown senses of a keyword that have the given part
+ *        of speech and definition, when they are given, and logs them.
+ *        The definition matches a sense shown with it, or one that adding
+ *        it would have stored. Returns the number of senses deleted.
+ */
+size_t Dictionary::deleteSenses(AccountedString &keyword,
+                                const AccountedString *partOfSpeech,
+                                const AccountedString *definition) {
+  standardizeKeyword(keyword);
+  AccountedString addedDefinition{AccountingAllocator<char>(&storageMemory)};
+  if (definition != nullptr && !definition->empty()) {
+    addedDefinition = *definition;
+    capitalizeFirstLetterOf(addedDefinition);
+    standardizeDefinition(addedDefinition);
+  }
+
+  // Find the senses first, as deleting them changes the edits visited.
+  // Every shown copy of a sense is deleted with it.
+  Entries deleted{Entries::allocator_type(&storageMemory)};
+  size_t deletedCount = 0;
+  visitEntries(keyword, keywordEntries.find(keyword), [&](const Entry &entry) {
+    if ((partOfSpeech == nullptr || entry.partOfSpeech == *partOfSpeech) &&
+        (definition == nullptr || entry.definition == *definition ||
+         entry.definition == addedDefinition)) {
+      ++deletedCount;
+      if (!containsSense(&deleted, entry)) {
+        deleted.push_back(entry);
+      }
+    }
+    return true;
+  });
+
+  for (Entry &entry : deleted) {
+    logEdit('-', keyword, entry);
+    if (removeSense(activeEdits.added, keyword, entry)) {
+      --activeEdits.count;
+    } else {
+      editsOf(activeEdits.deleted, keyword).push_back(std::move(entry));
+      ++activeEdits.count;
+    }
+  }
+  definitions -= deletedCount;
+  compactIfNeeded();
+  return deletedCount;
+}
+
+/**
+ * @brief Starts writing the stored entries and the edits so far to a new
+ *        data file, on another thread. Edits made meanwhile are kept
+ *        apart and stay in the edit log. Returns false if a compaction is
+ *        running, nothing was edited or edits are not saved.
+ */
+bool Dictionary::startCompaction() {
+  if (isCompacting() || !areEditsSaved) {
+    return false;
+  }
+  // The edits logged so far, including the ones replayed when loading,
+  // are the ones the new data file will hold.
+  compactedLogBytes = 0;
+  editLog.flush();
+  std::ifstream log(dataFilePath + ".log", ios::binary | ios::ate);
+  if (log.is_open()) {
+    compactedLogBytes = std::max<std::streamoff>(log.tellg(), 0);
+  }
+  if (activeEdits.count == 0 && compactedLogBytes == 0) {
+    return false;
+  }
+
+  std::swap(activeEdits.added, compactingEdits.added);
+  std::swap(activeEdits.deleted, compactingEdits.deleted);
+  std::swap(activeEdits.count, compactingEdits.count);
+  isCompactionDone = false;
+  hasCompactionFailed = false;
+  compaction = std::thread(&Dictionary::writeCompactedData, this);
+  return true;
+}
+
+/**
+ * @brief Once a compaction has written its data file, folds its edits
+ *        into the stored entries and drops them from the edit log. Only
+ *        waits for it if asked to.
+ */
+void Dictionary::finishCompaction(bool shouldWait) {
+  if (!isCompacting() || (!shouldWait && !isCompactionDone)) {
+    return;
+  }
+  compaction.join();
+  foldEdits(compactingEdits);
+  if (hasCompactionFailed) {
+    printCompactionError();
+    return;
+  }
+  writeEditLogTail();
+}
+
+bool Dictionary::isCompacting() const { return compaction.joinable(); }
+
+const string &Dictionary::getDataFilePath() const { return dataFilePath; }
+
+/**
+ * @brief Returns the bytes this dictionary holds right now, over all of
+ *        its parts.
+ */
+size_t Dictionary::getLiveBytes() const {
+  return parseMemory.getLiveBytes() + storageMemory.getLiveBytes() +
+         queryMemory.getLiveBytes() + outputMemory.getLiveBytes();
+}
+
+/**
+ * @brief Finds the entries of many keywords at once, putting nullptr for
+ *        the keywords this dictionary does not have. The found entries
+ *        are prefetched, as they are usually read next.
+ */
+void Dictionary::findEntries(const AccountedString *keywords, size_t count,
+                             const Entries **entries) {
+  keywordEntries.findBatch(keywords, count, entries);
+  for (size_t i = 0; i < count; i++) {
+    if (entries[i] != nullptr) {
+      prefetchForRead(entries[i]->data());
+    }
+  }
+}
+
+/**
+ * @brief Prints how much memory parsing, storing, querying and printing
+ *        entries have used.
+ */
+void Dictionary::printMemoryReport(std::ostream &out) {
+  out << "====== MEMORY REPORT =====\n";
+  parseMemory.printReport(out);
+  storageMemory.printReport(out);
+  queryMemory.printReport(out);
+  outputMemory.printReport(out);
+  queryArena.printReport(out);
+}
+
+/**
+ * @brief Writes every sense of this dictionary to a file in the given
+ *        format, in keyword order. Senses are formatted in chunks on
+ *        threadCount threads and each chunk is written at once.
+ */
+bool Dictionary::exportData(ExportFormat format, const string &path,
+                            unsigned threadCount) {
+  std::FILE *out = std::fopen(path.c_str(), "wb");
+  if (out == nullptr) {
+    printExportError(path);
+    return false;
+  }
+  // Chunks are large, so let them go straight to the file.
+  std::setvbuf(out, nullptr, _IONBF, 0);
+
+  cout << "! Exporting " << definitions << " senses of " << uniqueKeywords
+       << " keywords...\n";
+  auto start = std::chrono::steady_clock::now();
+
+  // Chunk i holds the keywords from chunkStarts[i] up to chunkStarts[i + 1].
+  vector<EntriesBatch::const_iterator> chunkStarts;
+  size_t sensesInChunk = SENSES_PER_EXPORT_CHUNK;
+  for (EntriesBatch::const_iterator keywordEntries = entriesBatch.begin();
+       keywordEntries != entriesBatch.end(); ++keywordEntries) {
+    if (sensesInChunk >= SENSES_PER_EXPORT_CHUNK) {
+      chunkStarts.push_back(keywordEntries);
+      sensesInChunk = 0;
+    }
+    sensesInChunk += keywordEntries->second.size();
+  }
+  chunkStarts.push_back(entriesBatch.end());
+
+  AccountedString header{AccountingAllocator<char>(&outputMemory)};
+  appendExportHeader(format, header);
+  bool isWritten =
+      std::fwrite(header.data(), 1, header.size(), out) == header.size();
+
+  ExportPipeline pipeline(threadCount, &outputMemory);
+  if (isWritten) {
+    isWritten = pipeline.run(
+        chunkStarts.size() - 1,
+        [this, format, &chunkStarts](size_t chunk, AccountedString &text) {
+          for (EntriesBatch::const_iterator keywordEntries =
+                   chunkStarts[chunk];
+               keywordEntries != chunkStarts[chunk + 1]; ++keywordEntries) {
+            for (const Entry &entry : keywordEntries->second) {
+              appendExportRecord(format, keywordEntries->first, entry, text);
+            }
+          }
+        },
+        out);
+  }
+  isWritten = (std::fclose(out) == 0) && isWritten;
+  if (!isWritten) {
+    printExportError(path);
+    return false;
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  printExportedData(path, header.size() + pipeline.getBytesWritten(),
+                    elapsed.count());
+  return true;
 }
 
 /** ---START:------ LOAD HELPER METHODS ------------------------- */
@@ -141,98 +535,658 @@ void Dictionary::printRequestForCorrectFilePath() {
 
 /** ---END:----   PARSE - LOAD HELPER METHODS ------------------------- */
 
-/** ---START:---- PARSE - DATA HELPER METHODS ------------------------- */
+/** ---START:---- EDIT HELPER METHODS ------------------------- */
 
 /**
- * @brief Capitalizes all letters of a word that begins
- *        with csc.
+ * @brief Applies the edit log of the data file at path, if it has one,
+ *        to the stored entries. New edits are appended to it.
  */
-void Dictionary::standardizeWord(string &lineContent) {
-  std::regex cscRegex("(^\\s*[cC][sS][cC])");
-  lineContent = std::regex_replace(lineContent, cscRegex, "CSC");
+void Dictionary::openEditLog(const string &path) {
+  dataFilePath = path;
+  std::ifstream log(path + ".log", ios::binary);
+  if (log.is_open()) {
+    replayEditLog(log);
+  }
 }
 
 /**
- * @brief Replaces the last part of a definition
- *        that has two periods with one period.
+ * @brief Applies each line of an edit log to the stored entries. A line
+ *        is '+' or '-', then the keyword, part of speech and definition,
+ *        separated by tabs. A '-' removes every stored copy of a sense and
+ *        a '+' stores one copy unless one is stored, as the edits did when
+ *        they were made. Applying a log again changes nothing, so a log
+ *        that outlived its compaction is harmless.
+ */
+void Dictionary::replayEditLog(istream &log) {
+  AccountingAllocator<char> parseAllocator(&parseMemory);
+  AccountedString line(parseAllocator);
+  AccountedString fields[3]{AccountedString(parseAllocator),
+                            AccountedString(parseAllocator),
+                            AccountedString(parseAllocator)};
+  KeywordPatternIndex::Keywords newKeywords{
+      KeywordPatternIndex::Keywords::allocator_type(&parseMemory)};
+  while (getline(log, line)) {
+    if (line.size() < 2 || (line[0] != '+' && line[0] != '-') ||
+        line[1] != '\t') {
+      continue;
+    }
+    size_t fieldStart = 2;
+    size_t fieldCount = 0;
+    while (fieldCount < 3 && fieldStart <= line.size()) {
+      size_t fieldEnd = (fieldCount < 2) ? line.find('\t', fieldStart)
+                                         : line.size();
+      if (fieldEnd == AccountedString::npos) {
+        break;
+      }
+      fields[fieldCount++].assign(line, fieldStart, fieldEnd - fieldStart);
+      fieldStart = fieldEnd + 1;
+    }
+    if (fieldCount < 3) {
+      continue;
+    }
+
+    Entry entry = makeEntry(fields[0], fields[1], fields[2]);
+    if (line[0] == '-') {
+      definitions -= deleteFromStoredEntries(fields[0], entry);
+    } else if (!containsSense(keywordEntries.find(fields[0]), entry)) {
+      addToStoredEntries(fields[0], std::move(entry), newKeywords);
+      definitions += 1;
+    }
+  }
+  keywordPatterns.addAll(newKeywords);
+}
+
+/**
+ * @brief Appends an edit to the edit log and flushes it, so that it is
+ *        not lost if this process ends.
+ */
+void Dictionary::logEdit(char operation, const AccountedString &keyword,
+                         const Entry &entry) {
+  if (dataFilePath.empty() || !areEditsSaved) {
+    return;
+  }
+  if (!editLog.is_open()) {
+    editLog.open(dataFilePath + ".log", ios::binary | ios::app);
+  }
+  editLog << operation << '\t' << keyword << '\t' << entry.partOfSpeech
+          << '\t' << entry.definition
+          << (needsExtraPeriod(entry.definition) ? "." : "") << '\n';
+  editLog.flush();
+}
+
+void Dictionary::compactIfNeeded() {
+  finishCompaction(false);
+  if (activeEdits.count >= EDITS_PER_COMPACTION) {
+    startCompaction();
+  }
+}
+
+/**
+ * @brief Writes the stored entries with the compacting edits to a new
+ *        data file, in the format it is loaded from, and puts it in
+ *        place of the old one. Runs on the compaction thread, which only
+ *        reads the stored entries and the compacting edits.
+ */
+void Dictionary::writeCompactedData() {
+  if (dataFilePath.empty()) {
+    isCompactionDone = true;
+    return;
+  }
+
+  string newPath = dataFilePath + ".compacting";
+  std::ofstream out(newPath, ios::binary | ios::trunc);
+  AccountedString line{AccountingAllocator<char>(&outputMemory)};
+  size_t keywordSize = 0;
+  bool hasLowerCaseSense = false;
+  // Only the last sense of a line keeps a lower case first letter when
+  // loaded, so those senses are written last, and each one after the
+  // first starts a line of its own.
+  auto appendSenses = [&](const Entries *entries, const Entries *deleted,
+                          bool isLowerCase) {
+    if (entries == nullptr) {
+      return;
+    }
+    for (const Entry &entry : *entries) {
+      bool startsLowerCase =
+          !entry.definition.empty() &&
+          std::islower(static_cast<unsigned char>(entry.definition[0]));
+      if (startsLowerCase != isLowerCase || containsSense(deleted, entry)) {
+        continue;
+      }
+      if (isLowerCase && hasLowerCaseSense) {
+        line += '\n';
+        out.write(line.data(), line.size());
+        line.erase(keywordSize);
+      }
+      hasLowerCaseSense = hasLowerCaseSense || isLowerCase;
+      line += DefaultLineGrammar::prePartOfSpeechDelimiter();
+      line += entry.partOfSpeech;
+      line += ' ';
+      line += DefaultLineGrammar::preDefinitionDelimiter();
+      line += ' ';
+      line += entry.definition;
+      if (needsExtraPeriod(entry.definition)) {
+        line += '.';
+      }
+    }
+  };
+  auto writeKeyword = [&](const AccountedString &keyword,
+                          const Entries *storedEntries) {
+    line = keyword;
+    keywordSize = line.size();
+    hasLowerCaseSense = false;
+    const Entries *added = findEdits(compactingEdits.added, keyword);
+    const Entries *deleted = findEdits(compactingEdits.deleted, keyword);
+    for (bool isLowerCase : {false, true}) {
+      appendSenses(storedEntries, deleted, isLowerCase);
+      appendSenses(added, nullptr, isLowerCase);
+    }
+    if (line.size() > keywordSize) {
+      line += '\n';
+      out.write(line.data(), line.size());
+    }
+  };
+
+  // Merge the stored keywords with the added ones, both in sorted order.
+  EntriesBatch::const_iterator added = compactingEdits.added.begin();
+  for (const auto &storedEntries : entriesBatch) {
+    for (; added != compactingEdits.added.end() &&
+           added->first < storedEntries.first;
+         ++added) {
+      writeKeyword(added->first, nullptr);
+    }
+    if (added != compactingEdits.added.end() &&
+        added->first == storedEntries.first) {
+      ++added;
+    }
+    writeKeyword(storedEntries.first, &storedEntries.second);
+  }
+  for (; added != compactingEdits.added.end(); ++added) {
+    writeKeyword(added->first, nullptr);
+  }
+
+  out.close();
+  if (!out || std::rename(newPath.c_str(), dataFilePath.c_str()) != 0) {
+    // Some systems do not rename over an existing file.
+    if (!out || std::remove(dataFilePath.c_str()) != 0 ||
+        std::rename(newPath.c_str(), dataFilePath.c_str()) != 0) {
+      hasCompactionFailed = true;
+    }
+  }
+  isCompactionDone = true;
+}
+
+/**
+ * @brief Rewrites the edit log with only the edits made since the
+ *        compaction started, which the new data file does not hold, or
+ *        removes it if there are none.
+ */
+void Dictionary::writeEditLogTail() {
+  if (dataFilePath.empty()) {
+    return;
+  }
+  editLog.close();
+  string logPath = dataFilePath + ".log";
+  string tailPath = logPath + ".tail";
+  bool hasTail;
+  {
+    std::ifstream log(logPath, ios::binary | ios::ate);
+    hasTail = log.is_open() && log.tellg() > compactedLogBytes;
+    if (hasTail) {
+      std::ofstream tail(tailPath, ios::binary | ios::trunc);
+      log.seekg(compactedLogBytes);
+      tail << log.rdbuf();
+    }
+  }
+  if (!hasTail) {
+    std::remove(logPath.c_str());
+  } else if (std::rename(tailPath.c_str(), logPath.c_str()) != 0) {
+    // Some systems do not rename over an existing file.
+    std::remove(logPath.c_str());
+    std::rename(tailPath.c_str(), logPath.c_str());
+  }
+}
+
+/**
+ * @brief Moves a set of edits into the stored entries and the keyword
+ *        indexes.
+ */
+void Dictionary::foldEdits(SenseEdits &edits) {
+  KeywordPatternIndex::Keywords newKeywords{
+      KeywordPatternIndex::Keywords::allocator_type(&storageMemory)};
+  for (const auto &deletedEntries : edits.deleted) {
+    for (const Entry &entry : deletedEntries.second) {
+      deleteFromStoredEntries(deletedEntries.first, entry);
+    }
+  }
+  for (auto &addedEntries : edits.added) {
+    for (Entry &entry : addedEntries.second) {
+      addToStoredEntries(addedEntries.first, std::move(entry), newKeywords);
+    }
+  }
+  keywordPatterns.addAll(newKeywords);
+  edits.added.clear();
+  edits.deleted.clear();
+  edits.count = 0;
+}
+
+bool Dictionary::isShown(const AccountedString &keyword, const Entry &sense) {
+  bool isFound = false;
+  visitEntries(keyword, keywordEntries.find(keyword),
+               [&isFound, &sense](const Entry &entry) {
+                 isFound = isSameSense(entry, sense);
+                 return !isFound;
+               });
+  return isFound;
+}
+
+/**
+ * @brief Returns true if a stored definition ends with two periods. Its
+ *        file form needs a third one, as loading turns a last '..' to '.'.
+ */
+bool Dictionary::needsExtraPeriod(const AccountedString &definition) {
+  size_t size = definition.size();
+  return size >= 2 && definition[size - 1] == '.' &&
+         definition[size - 2] == '.';
+}
+
+bool Dictionary::isSameSense(const Entry &entry1, const Entry &entry2) {
+  return entry1.partOfSpeech == entry2.partOfSpeech &&
+         entry1.definition == entry2.definition;
+}
+
+bool Dictionary::containsSense(const Entries *entries, const Entry &sense) {
+  if (entries == nullptr) {
+    return false;
+  }
+  for (const Entry &entry : *entries) {
+    if (isSameSense(entry, sense)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns the edited senses of a keyword, or nullptr if it has
+ *        none.
+ */
+const Dictionary::Entries *
+Dictionary::findEdits(const EntriesBatch &edits,
+                      const AccountedString &keyword) {
+  if (edits.empty()) {
+    return nullptr;
+  }
+  EntriesBatch::const_iterator keywordEdits = edits.find(keyword);
+  return (keywordEdits == edits.end()) ? nullptr : &keywordEdits->second;
+}
+
+Dictionary::Entries &Dictionary::editsOf(EntriesBatch &edits,
+                                         const AccountedString &keyword) {
+  EntriesBatch::iterator keywordEdits = edits.find(keyword);
+  if (keywordEdits == edits.end()) {
+    AccountingAllocator<char> storageAllocator(&storageMemory);
+    keywordEdits = edits
+                       .emplace(AccountedString(keyword, storageAllocator),
+                                Entries(storageAllocator))
+                       .first;
+  }
+  return keywordEdits->second;
+}
+
+/**
+ * @brief Removes a sense from the edits of a keyword. Returns false if
+ *        it was not there.
+ */
+bool Dictionary::removeSense(EntriesBatch &edits,
+                             const AccountedString &keyword,
+                             const Entry &sense) {
+  EntriesBatch::iterator keywordEdits = edits.find(keyword);
+  if (keywordEdits == edits.end()) {
+    return false;
+  }
+  Entries &entries = keywordEdits->second;
+  for (Entries::iterator entry = entries.begin(); entry != entries.end();
+       ++entry) {
+    if (isSameSense(*entry, sense)) {
+      entries.erase(entry);
+      if (entries.empty()) {
+        edits.erase(keywordEdits);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Stores a sense of a keyword, indexing the keyword if it is new.
+ *        New keywords are also put into newKeywords, for the caller to
+ *        add to the pattern index all at once. Stored keywords are never
+ *        removed, as the indexes point to them.
  */
-void Dictionary::standardizeDefinition(string &definition) {
-  std::regex twoPeriodsFromEndRegex("\\.\\.\\s*$");
-  definition = std::regex_replace(definition, twoPeriodsFromEndRegex, ".");
+void Dictionary::addToStoredEntries(
+    const AccountedString &keyword, Entry &&entry,
+    KeywordPatternIndex::Keywords &newKeywords) {
+  EntriesBatch::iterator storedEntries = entriesBatch.find(keyword);
+  if (storedEntries == entriesBatch.end()) {
+    AccountingAllocator<char> storageAllocator(&storageMemory);
+    storedEntries = entriesBatch
+                        .emplace(AccountedString(keyword, storageAllocator),
+                                 Entries(storageAllocator))
+                        .first;
+    keywordFilter.add(keyword.data(), keyword.size());
+    newKeywords.push_back(&storedEntries->first);
+    keywordEntries.add(storedEntries->first, &storedEntries->second);
+  }
+  if (storedEntries->second.empty()) {
+    uniqueKeywords += 1;
+  }
+  storedEntries->second.push_back(std::move(entry));
+}
+
+/**
+ * @brief Removes every stored copy of a sense of a keyword. Returns the
+ *        number of copies removed.
+ */
+size_t Dictionary::deleteFromStoredEntries(const AccountedString &keyword,
+                                           const Entry &sense) {
+  EntriesBatch::iterator storedEntries = entriesBatch.find(keyword);
+  if (storedEntries == entriesBatch.end()) {
+    return 0;
+  }
+  Entries &entries = storedEntries->second;
+  size_t oldSize = entries.size();
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [&sense](const Entry &entry) {
+                                 return isSameSense(entry, sense);
+                               }),
+                entries.end());
+  if (oldSize > 0 && entries.empty()) {
+    uniqueKeywords -= 1;
+  }
+  return oldSize - entries.size();
+}
+
+void Dictionary::printCompactionError() {
+  cout << "<!>ERROR<!> ===>" << ' '
+       << "Compacted data file could not be written."
+       << "\n";
+  cout << "<!>ERROR<!> ===>" << ' ' << "The edits stay in:" << ' '
+       << dataFilePath << ".log\n";
+}
+
+/** ---END:---- EDIT HELPER METHODS ------------------------- */
+
+/** ---START:---- EXPORT HELPER METHODS ------------------------- */
+
+void Dictionary::printExportError(const string &path) {
+  cout << "<!>ERROR<!> ===>" << ' ' << "Export file could not be written."
+       << "\n";
+  cout << "<!>ERROR<!> ===>" << ' ' << "Provided file path:" << ' ' << path
+       << "\n";
+}
+
+void Dictionary::printExportedData(const string &path, size_t bytes,
+                                   double seconds) {
+  double megabytes = bytes / (1024.0 * 1024.0);
+  cout << "! Exporting completed..."
+       << "\n";
+  cout << "! Wrote " << bytes << " bytes to " << path << " in " << seconds
+       << " s (" << ((seconds > 0) ? megabytes / seconds : 0) << " MB/s)\n";
+}
+
+/**
+ * @brief Appends the line naming the fields of a record, for the formats
+ *        that have one.
+ */
+void Dictionary::appendExportHeader(ExportFormat format,
+                                    AccountedString &out) {
+  if (format == ExportFormat::TSV) {
+    out += "keyword\tword\tpartOfSpeech\tdefinition\n";
+  } else if (format == ExportFormat::CSV) {
+    out += "keyword,word,partOfSpeech,definition\r\n";
+  }
+}
+
+/**
+ * @brief Appends one sense of a keyword as a line of the given format.
+ */
+void Dictionary::appendExportRecord(ExportFormat format,
+                                    const AccountedString &keyword,
+                                    const Entry &entry, AccountedString &out) {
+  switch (format) {
+  case ExportFormat::JSONL:
+    out += "{\"keyword\":";
+    appendJsonString(keyword, out);
+    out += ",\"word\":";
+    appendJsonString(entry.word, out);
+    out += ",\"partOfSpeech\":";
+    appendJsonString(entry.partOfSpeech, out);
+    out += ",\"definition\":";
+    appendJsonString(entry.definition, out);
+    out += "}\n";
+    break;
+  case ExportFormat::TSV:
+    appendTsvField(keyword, out);
+    out += '\t';
+    appendTsvField(entry.word, out);
+    out += '\t';
+    appendTsvField(entry.partOfSpeech, out);
+    out += '\t';
+    appendTsvField(entry.definition, out);
+    out += '\n';
+    break;
+  case ExportFormat::CSV:
+    appendCsvField(keyword, out);
+    out += ',';
+    appendCsvField(entry.word, out);
+    out += ',';
+    appendCsvField(entry.partOfSpeech, out);
+    out += ',';
+    appendCsvField(entry.definition, out);
+    out += "\r\n";
+    break;
+  }
+}
+
+/**
+ * @brief Appends a field as a quoted JSON string. Bytes above 0x7F are
+ *        copied as they are, so UTF-8 data stays UTF-8.
+ */
+void Dictionary::appendJsonString(const AccountedString &field,
+                                  AccountedString &out) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  out += '"';
+  for (char character : field) {
+    unsigned char byte = static_cast<unsigned char>(character);
+    if (character == '"' || character == '\\') {
+      out += '\\';
+      out += character;
+    } else if (character == '\n') {
+      out += "\\n";
+    } else if (character == '\t') {
+      out += "\\t";
+    } else if (byte < 0x20) {
+      out += "\\u00";
+      out += HEX_DIGITS[byte >> 4];
+      out += HEX_DIGITS[byte & 0xF];
+    } else {
+      out += character;
+    }
+  }
+  out += '"';
 }
 
 /**
- * @brief Return true if a given string s1 has a delimiter s2.
+ * @brief Appends a field of a tab-separated line, escaping the tabs,
+ *        line breaks and backslashes in it.
  */
-bool Dictionary::hasDelimiter(string &s1, string &s2) {
-  return (s1.find(s2) != std::string::npos) ? true : false;
+void Dictionary::appendTsvField(const AccountedString &field,
+                                AccountedString &out) {
+  for (char character : field) {
+    if (character == '\t') {
+      out += "\\t";
+    } else if (character == '\n') {
+      out += "\\n";
+    } else if (character == '\r') {
+      out += "\\r";
+    } else if (character == '\\') {
+      out += "\\\\";
+    } else {
+      out += character;
+    }
+  }
 }
 
-string Dictionary::getDefinitionPartOf(string &content, string &delimiter) {
-  int delimiterIndex = content.find(delimiter);
-  string word = content.substr(0, delimiterIndex);
-  return word;
+/**
+ * @brief Appends a field of a comma-separated line. Fields with commas,
+ *        quotes or line breaks are quoted, with their quotes doubled.
+ */
+void Dictionary::appendCsvField(const AccountedString &field,
+                                AccountedString &out) {
+  if (field.find_first_of(",\"\r\n") == AccountedString::npos) {
+    out += field;
+    return;
+  }
+  out += '"';
+  for (char character : field) {
+    if (character == '"') {
+      out += '"';
+    }
+    out += character;
+  }
+  out += '"';
 }
 
-string Dictionary::getWordPartOf(string &content, string &delimiter) {
-  int delimiterIndex = content.find(delimiter);
-  string word = content.substr(0, delimiterIndex);
-  capitalizeFirstLetterOf(word);
-  return word;
+/** ---END:---- EXPORT HELPER METHODS ------------------------- */
+
+/** ---START:---- PARSE - DATA HELPER METHODS ------------------------- */
+
+/**
+ * @brief Capitalizes all letters of a word that begins
+ *        with csc.
+ */
+void Dictionary::standardizeWord(AccountedString &word) {
+  size_t start = 0;
+  while (start < word.size() &&
+         std::isspace(static_cast<unsigned char>(word[start]))) {
+    ++start;
+  }
+  auto lowerCaseAt = [&word, start](size_t i) {
+    return std::tolower(static_cast<unsigned char>(word[start + i]));
+  };
+  if (word.size() - start >= 3 && lowerCaseAt(0) == 'c' &&
+      lowerCaseAt(1) == 's' && lowerCaseAt(2) == 'c') {
+    word.replace(0, start + 3, "CSC");
+  }
 }
 
-string Dictionary::getPartOfSpeechPartOf(string &content, string delimiter) {
-  int delimiterIndex = content.find(delimiter);
-  string partOfSpeech = content.substr(delimiterIndex + 1, content.size());
-  lowerCaseFirstLetterOf(partOfSpeech);
-  return partOfSpeech;
+/**
+ * @brief Replaces the last part of a definition
+ *        that has two periods with one period.
+ */
+void Dictionary::standardizeDefinition(AccountedString &definition) {
+  size_t end = definition.size();
+  while (end > 0 &&
+         std::isspace(static_cast<unsigned char>(definition[end - 1]))) {
+    --end;
+  }
+  if (end >= 2 && definition[end - 1] == '.' && definition[end - 2] == '.') {
+    definition.replace(end - 2, definition.size() - end + 2, ".");
+  }
 }
 
-void Dictionary::eraseCarriageReturnsOf(string &content) {
+void Dictionary::eraseCarriageReturnsOf(AccountedString &content) {
   content.erase(std::remove(content.begin(), content.end(), '\r'),
                 content.end());
 }
 
-void Dictionary::eraseLeadingAndTrailingWhiteSpacesOf(string &content) {
+void Dictionary::eraseLeadingAndTrailingWhiteSpacesOf(
+    AccountedString &content) {
   content = std::regex_replace(content, std::regex("^ +| +$|( ) +"), "$1");
 }
 
-void Dictionary::capitalizeFirstLetterOf(string &word) {
+void Dictionary::capitalizeFirstLetterOf(AccountedString &word) {
   word[0] = toupper(word[0]);
 }
 
-void Dictionary::capitalizeAllLettersOf(string &word) {
+void Dictionary::capitalizeAllLettersOf(AccountedString &word) {
   for_each(word.begin(), word.end(), [](char &c) { c = ::toupper(c); });
 }
 
-void Dictionary::lowerCaseFirstLetterOf(string &word) {
+void Dictionary::lowerCaseFirstLetterOf(AccountedString &word) {
   word[0] = tolower(word[0]);
 }
 
-void Dictionary::lowerCaseAllLettersOf(string &content) {
+void Dictionary::lowerCaseAllLettersOf(AccountedString &content) {
   std::for_each(content.begin(), content.end(),
                 [](char &c) { c = ::tolower(c); });
 }
 
+/**
+ * @brief Spells a keyword the way it is stored: lower case, but for its
+ *        first letter.
+ */
+void Dictionary::standardizeKeyword(AccountedString &keyword) {
+  lowerCaseAllLettersOf(keyword);
+  capitalizeFirstLetterOf(keyword);
+}
+
+/**
+ * @brief Puts every keyword of this dictionary into the keyword filter,
+ *        so that searches for missing keywords can be rejected without
+ *        walking the entries, into the index of keyword patterns, and
+ *        into the hash index of their entries.
+ */
+void Dictionary::buildKeywordIndexes() {
+  keywordFilter.reserve(entriesBatch.size());
+  keywordPatterns.clear();
+  keywordEntries.clear();
+  keywordEntries.reserve(entriesBatch.size());
+  for (const auto &storedEntries : entriesBatch) {
+    keywordFilter.add(storedEntries.first.data(), storedEntries.first.size());
+    keywordPatterns.add(storedEntries.first);
+    keywordEntries.add(storedEntries.first, &storedEntries.second);
+  }
+}
+
+/**
+ * @brief Makes a standardized entry, stored as storage memory, out of
+ *        the given word properties.
+ */
+Dictionary::Entry Dictionary::makeEntry(AccountedString &word,
+                                        AccountedString &partOfSpeech,
+                                        AccountedString &definition) {
+  AccountingAllocator<char> storageAllocator(&storageMemory);
+  Entry entry = {AccountedString(word, storageAllocator),
+                 AccountedString(partOfSpeech, storageAllocator),
+                 AccountedString(definition, storageAllocator)};
+  standardizeWord(entry.word);
+  standardizeDefinition(entry.definition);
+  return entry;
+}
+
 /**
  * @brief Make a new Entry out of out of the given entries and word properties.
  *        Words and definitions are also standardized,that is, all entry words
  *        should be capitalized, and that image definitions should only
  *        end with one period.
  */
-void Dictionary::makeNewEntry(map<string, vector<Entry>> &entriesBatch,
-                              string &word, string &partOfSpeech,
-                              string &definition) {
+void Dictionary::makeNewEntry(EntriesBatch &entriesBatch, AccountedString &word,
+                              AccountedString &partOfSpeech,
+                              AccountedString &definition) {
   definitions += 1;
-  Entry newEntry = {word, partOfSpeech, definition, true};
-  standardizeWord(newEntry.word);
-  standardizeDefinition(newEntry.definition);
-  if (!(entriesBatch.find(word) == entriesBatch.end())) {
-    entriesBatch.find(word)->second.push_back(newEntry);
-    return;
+  AccountingAllocator<char> storageAllocator(&storageMemory);
+  Entry newEntry = makeEntry(word, partOfSpeech, definition);
+  EntriesBatch::iterator keywordEntries = entriesBatch.find(word);
+  if (keywordEntries == entriesBatch.end()) {
+    keywordEntries = entriesBatch
+                         .emplace(AccountedString(word, storageAllocator),
+                                  Entries(storageAllocator))
+                         .first;
   }
-  vector<Entry> emptyEntryVector{newEntry};
-  entriesBatch[word] = emptyEntryVector;
+  keywordEntries->second.push_back(std::move(newEntry));
 }
 
 /** ---END:---- PARSE - DATA HELPER METHODS ------------------------- */
@@ -14,6 +14,7 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -21,43 +22,137 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
-#include "CycleVector.h"
+#include "BloomFilter.h"
+#include "KeywordHashIndex.h"
+#include "KeywordPatternIndex.h"
+#include "LineParser.h"
+#include "MemoryAccounting.h"
 
 class Dictionary {
 public:
+  enum class ExportFormat { JSONL, TSV, CSV };
+
+  Dictionary();
+  ~Dictionary();
+
   void populateWithData();
+  bool loadFromFile(const std::string &path);
+  std::size_t getLiveBytes() const;
+  void printMemoryReport(std::ostream &out);
+  bool exportData(ExportFormat format, const std::string &path,
+                  unsigned threadCount);
 
 protected:
+  static const std::size_t QUERY_ARENA_BYTES = 16 * 1024;
+
   int uniqueKeywords{0};
   int definitions{0};
+  /** False while edits must only change what is in memory, such as when
+   *  a session is replayed. */
+  bool areEditsSaved{true};
 
-  struct Entry {
-    std::string word;
-    std::string partOfSpeech;
-    std::string definition;
-    bool exists;
+  TrackingResource parseMemory{"parse"};
+  TrackingResource storageMemory{"storage"};
+  TrackingResource queryMemory{"query"};
+  TrackingResource outputMemory{"output"};
+  ArenaResource queryArena{QUERY_ARENA_BYTES, &queryMemory};
 
-    std::string toString() {
-      return "        " + word + " [" + partOfSpeech + "] : " + definition;
+  struct Entry {
+    AccountedString word;
+    AccountedString partOfSpeech;
+    AccountedString definition;
+
+    void appendTo(AccountedString &out) const {
+      out += "        ";
+      out += word;
+      out += " [";
+      out += partOfSpeech;
+      out += "] : ";
+      out += definition;
     }
   };
 
-  std::map<std::string, std::vector<Entry>> entriesBatch;
-
-  void eraseCarriageReturnsOf(std::string &content);
-  void eraseLeadingAndTrailingWhiteSpacesOf(std::string &);
-  void capitalizeFirstLetterOf(std::string &);
-  void capitalizeAllLettersOf(std::string &);
-  void lowerCaseAllLettersOf(std::string &word);
-  void lowerCaseFirstLetterOf(std::string &word);
+  typedef std::vector<Entry, AccountingAllocator<Entry>> Entries;
+  typedef std::map<
+      AccountedString, Entries, std::less<AccountedString>,
+      AccountingAllocator<std::pair<const AccountedString, Entries>>>
+      EntriesBatch;
+  typedef std::vector<const Entry *, AccountingAllocator<const Entry *>>
+      EntryViews;
+
+  EntriesBatch entriesBatch;
+  BloomFilter keywordFilter;
+  KeywordPatternIndex keywordPatterns;
+  KeywordHashIndex<Entries> keywordEntries;
+
+  void eraseCarriageReturnsOf(AccountedString &content);
+  void eraseLeadingAndTrailingWhiteSpacesOf(AccountedString &);
+  void capitalizeFirstLetterOf(AccountedString &);
+  void capitalizeAllLettersOf(AccountedString &);
+  void lowerCaseAllLettersOf(AccountedString &word);
+  void lowerCaseFirstLetterOf(AccountedString &word);
+  void standardizeKeyword(AccountedString &keyword);
+
+  void parseData(std::istream &, EntriesBatch &);
+  void findEntries(const AccountedString *keywords, std::size_t count,
+                   const Entries **entries);
+
+  bool hasEntries(const AccountedString &keyword);
+  void collectEntries(const AccountedString &keyword, EntryViews &views);
+  std::size_t countEntries(const AccountedString &keyword,
+                           const Entries *storedEntries);
+  void matchKeywords(const AccountedString &pattern,
+                     KeywordPatternIndex::Keywords &matches);
+
+  bool addSense(AccountedString &keyword, AccountedString &partOfSpeech,
+                AccountedString &definition);
+  std::size_t deleteSenses(AccountedString &keyword,
+                           const AccountedString *partOfSpeech,
+                           const AccountedString *definition);
+  bool startCompaction();
+  void finishCompaction(bool shouldWait);
+  bool isCompacting() const;
+  const std::string &getDataFilePath() const;
 
 private:
   std::string DEFAULT_FILE_PATH{
       "C:\\Users\\MickeyMouse\\AbsolutePath\\DB\\Data.CS.SFSU.txt"};
-  std::string PRE_DEFINITION_DELIMITER{"-=>>"};
-  std::string PRE_PART_OF_SPEECH_DELIMITER{"|"};
+  static const std::size_t SENSES_PER_EXPORT_CHUNK = 4096;
+  static const std::size_t EDITS_PER_COMPACTION = 1024;
+
+  struct EntryCollector;
+
+  /**
+   * @brief   Senses added and deleted at runtime, by keyword, on top of the
+   *          stored entries. Deleting a sense hides every copy of it below,
+   *          and a sense is only added, as one copy, if it is not shown.
+   *          A deleted sense added back is in both.
+   */
+  struct SenseEdits {
+    EntriesBatch added;
+    EntriesBatch deleted;
+    std::size_t count;
+
+    explicit SenseEdits(MemoryResource *resource)
+        : added(EntriesBatch::allocator_type(resource)),
+          deleted(EntriesBatch::allocator_type(resource)), count(0) {}
+  };
+
+  /** Edits since the last compaction started, and the edits being
+   *  compacted. Lookups show the stored entries, then the compacting
+   *  edits, then the active ones. */
+  SenseEdits activeEdits{&storageMemory};
+  SenseEdits compactingEdits{&storageMemory};
+
+  std::string dataFilePath;
+  std::ofstream editLog;
+  std::thread compaction;
+  std::atomic<bool> isCompactionDone{false};
+  bool hasCompactionFailed{false};
+  std::streamoff compactedLogBytes{0};
 
   void loadData(std::string);
   void openDataFile(std::ifstream &, std::string &);
@@ -67,24 +162,56 @@ private:
   void printFileOpenError(std::string &);
   void printRequestForCorrectFilePath();
 
-  void parseData(std::ifstream &, std::map<std::string, std::vector<Entry>> &);
-  void makeNewEntry(std::map<std::string, std::vector<Entry>> &,
-                    std::string &word, std::string &partOfSpeech,
-                    std::string &definition);
-  void standardizeDefinition(std::string &definition);
+  void printExportError(const std::string &path);
+  void printCompactionError();
+  void printExportedData(const std::string &path, std::size_t bytes,
+                         double seconds);
+
+  void appendExportHeader(ExportFormat, AccountedString &out);
+  void appendExportRecord(ExportFormat, const AccountedString &keyword,
+                          const Entry &, AccountedString &out);
+  static void appendJsonString(const AccountedString &, AccountedString &out);
+  static void appendTsvField(const AccountedString &, AccountedString &out);
+  static void appendCsvField(const AccountedString &, AccountedString &out);
+
+  void openEditLog(const std::string &path);
+  void replayEditLog(std::istream &log);
+  void logEdit(char operation, const AccountedString &keyword, const Entry &);
+  void compactIfNeeded();
+  void writeCompactedData();
+  void writeEditLogTail();
+  void foldEdits(SenseEdits &);
+
+  template <typename Visit>
+  void visitEntries(const AccountedString &keyword,
+                    const Entries *storedEntries, Visit visit);
+  bool isShown(const AccountedString &keyword, const Entry &);
+  static bool needsExtraPeriod(const AccountedString &definition);
+  static bool isSameSense(const Entry &, const Entry &);
+  static bool containsSense(const Entries *, const Entry &);
+  static const Entries *findEdits(const EntriesBatch &,
+                                  const AccountedString &keyword);
+  Entries &editsOf(EntriesBatch &, const AccountedString &keyword);
+  static bool removeSense(EntriesBatch &, const AccountedString &keyword,
+                          const Entry &);
+  void addToStoredEntries(const AccountedString &keyword, Entry &&,
+                          KeywordPatternIndex::Keywords &newKeywords);
+  std::size_t deleteFromStoredEntries(const AccountedString &keyword,
+                                      const Entry &);
+
+  void buildKeywordIndexes();
+  Entry makeEntry(AccountedString &word, AccountedString &partOfSpeech,
+                  AccountedString &definition);
+  void makeNewEntry(EntriesBatch &, AccountedString &word,
+                    AccountedString &partOfSpeech, AccountedString &definition);
+  void standardizeDefinition(AccountedString &definition);
+
+  void standardizeWord(AccountedString &word); /** TODO: */
 
-  void standardizeWord(std::string &word); /** TODO: */
-
-  bool hasDelimiter(std::string &, std::string &);
   bool shoudlOnlyHaveOnePeriod(std::string &); /** TODO: */
 
   std::vector<std::string> words;
   std::vector<std::map<std::string, std::string>> definition;
-
-  std::string getDefinitionPartOf(std::string &content, std::string &delimiter);
-  std::string getWordPartOf(std::string &content, std::string &delimiter);
-  std::string getPartOfSpeechPartOf(std::string &content,
-                                    std::string delimiter);
 };
 
 #endif // DICTIONARY_H
@@ -0,0 +1,270 @@
+/**
+ * File:        DictionaryHost.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  that serve searches from many interactive dictionaries, loading
+ *  each when it is first searched and evicting the least recently
+ *  used ones to stay within a memory budget.
+ */
+
+#include "DictionaryHost.h"
+
+#include <chrono>
+
+using std::cin;
+using std::cout;
+using std::size_t;
+using std::string;
+
+/**
+ * @brief Constructs a host without dictionaries, which keeps the loaded
+ *        ones within the given number of bytes when it can.
+ */
+DictionaryHost::DictionaryHost(size_t memoryBudgetBytes)
+    : memoryBudget(memoryBudgetBytes) {}
+
+/**
+ * @brief Registers the data file at path under a name, without loading
+ *        it. The first registered dictionary is searched until another
+ *        one is selected. Returns false if the name is taken.
+ */
+bool DictionaryHost::registerDictionary(const string &name,
+                                        const string &path) {
+  if (dictionaries.count(name) != 0) {
+    return false;
+  }
+  HostedDictionary &hosted = dictionaries[name];
+  hosted.name = name;
+  hosted.path = path;
+  if (current == nullptr) {
+    current = &hosted;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads searches until the client quits. A search starting with
+ *        '@name' goes to that dictionary, which is then searched by the
+ *        following searches too; '@name' alone only selects it, and
+ *        loads it on its first search.
+ */
+void DictionaryHost::read() {
+  printIntroduction();
+
+  int searchCount{0};
+  string line;
+  AccountedString searchQuery;
+  while (true) {
+    ++searchCount;
+    cout << "Search [" << searchCount << "]: ";
+
+    if (!getline(cin, line)) {
+      break;
+    }
+    if (isMetricsReport(line)) {
+      printMetrics(cout);
+      continue;
+    }
+    if (!selectDictionary(line) || current == nullptr || line.empty()) {
+      continue;
+    }
+    if (isQuit(line) && !current->dictionary) {
+      // There is nothing to load just to say goodbye.
+      break;
+    }
+
+    InteractiveDictionary *dictionary = use(*current);
+    if (dictionary == nullptr) {
+      continue;
+    }
+    ++searches;
+    searchQuery.assign(line.data(), line.size());
+    if (!dictionary->respond(searchQuery)) {
+      break;
+    }
+    // Searching can grow a dictionary's buffers too.
+    evictUntilWithinBudget();
+  }
+}
+
+/**
+ * @brief Prints how the memory budget is used, and how often and how
+ *        slowly dictionaries were loaded and evicted.
+ */
+void DictionaryHost::printMetrics(std::ostream &out) {
+  out << "====== DICTIONARIES =====\n";
+  out << "------ budget: ";
+  if (memoryBudget == NO_BUDGET) {
+    out << "none";
+  } else {
+    out << memoryBudget << " bytes";
+  }
+  out << ", " << getResidentBytes() << " bytes resident\n";
+  out << "------ " << searches << " searches, " << loads << " loads ("
+      << reloads << " reloads) in " << loadSeconds << " s, " << evictions
+      << " evictions of " << evictedBytes << " bytes\n";
+  for (auto &named : dictionaries) {
+    HostedDictionary &hosted = named.second;
+    out << "------ " << hosted.name << ": ";
+    if (hosted.dictionary) {
+      out << hosted.dictionary->getLiveBytes() << " bytes";
+    } else {
+      out << "not loaded";
+    }
+    out << ", " << hosted.loads << " loads in " << hosted.loadSeconds
+        << " s, " << hosted.evictions << " evictions (" << hosted.path
+        << ")\n";
+  }
+}
+
+/** ---START:------ LOAD AND EVICT HELPER METHODS ------------------------- */
+
+/**
+ * @brief Returns the dictionary of a registered data file, loading it if
+ *        it is not loaded, and marks it as the most recently used one.
+ *        Returns nullptr if it could not be loaded.
+ */
+InteractiveDictionary *DictionaryHost::use(HostedDictionary &hosted) {
+  if (hosted.dictionary) {
+    recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, hosted.recentUse);
+    return hosted.dictionary.get();
+  }
+  if (!load(hosted)) {
+    printLoadError(hosted);
+    return nullptr;
+  }
+  evictUntilWithinBudget();
+  return hosted.dictionary.get();
+}
+
+/**
+ * @brief Loads a registered data file and times it. Returns false if it
+ *        could not be opened.
+ */
+bool DictionaryHost::load(HostedDictionary &hosted) {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<InteractiveDictionary> dictionary(new InteractiveDictionary);
+  if (!dictionary->loadFromFile(hosted.path)) {
+    return false;
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (hosted.loads > 0) {
+    ++reloads;
+  }
+  ++loads;
+  ++hosted.loads;
+  loadSeconds += elapsed.count();
+  hosted.loadSeconds += elapsed.count();
+
+  hosted.dictionary = std::move(dictionary);
+  recentlyUsed.push_front(&hosted);
+  hosted.recentUse = recentlyUsed.begin();
+
+  cout << "! Loaded dictionary " << hosted.name << " ("
+       << hosted.dictionary->getLiveBytes() << " bytes in " << elapsed.count()
+       << " s)\n";
+  return true;
+}
+
+void DictionaryHost::evict(HostedDictionary &hosted) {
+  size_t bytes = hosted.dictionary->getLiveBytes();
+  recentlyUsed.erase(hosted.recentUse);
+  hosted.dictionary.reset();
+
+  ++evictions;
+  ++hosted.evictions;
+  evictedBytes += bytes;
+
+  cout << "! Evicted dictionary " << hosted.name << " (" << bytes
+       << " bytes)\n";
+}
+
+/**
+ * @brief Evicts the least recently used dictionaries until the loaded
+ *        ones fit in the memory budget. The most recently used one is
+ *        always kept, even if it does not fit on its own.
+ */
+void DictionaryHost::evictUntilWithinBudget() {
+  while (recentlyUsed.size() > 1 && getResidentBytes() > memoryBudget) {
+    evict(*recentlyUsed.back());
+  }
+}
+
+size_t DictionaryHost::getResidentBytes() {
+  size_t bytes = 0;
+  for (HostedDictionary *hosted : recentlyUsed) {
+    bytes += hosted->dictionary->getLiveBytes();
+  }
+  return bytes;
+}
+
+/** ---END:-------- LOAD AND EVICT HELPER METHODS ------------------------- */
+
+/** ---START:------ SEARCH HELPER METHODS ------------------------- */
+
+/**
+ * @brief Selects the dictionary named by a leading '@name' and removes
+ *        it from the search. Returns false if there is no such dictionary.
+ */
+bool DictionaryHost::selectDictionary(string &searchQuery) {
+  if (searchQuery.empty() || searchQuery[0] != '@') {
+    return true;
+  }
+  size_t nameEnd = searchQuery.find_first_of(" \t\r", 1);
+  string name = searchQuery.substr(1, nameEnd - 1);
+  auto named = dictionaries.find(name);
+  if (named == dictionaries.end()) {
+    printUnknownDictionary(name);
+    return false;
+  }
+  current = &named->second;
+
+  size_t searchStart = searchQuery.find_first_not_of(" \t\r", nameEnd);
+  searchQuery.erase(0, searchStart);
+  return true;
+}
+
+bool DictionaryHost::isQuit(string &searchQuery) {
+  return (searchQuery == "!q");
+}
+
+bool DictionaryHost::isMetricsReport(string &searchQuery) {
+  return (searchQuery == "!dictionaries");
+}
+
+/** ---END:-------- SEARCH HELPER METHODS ------------------------- */
+
+/** ---START:------ PRINT HELPER METHODS ------------------------- */
+
+void DictionaryHost::printIntroduction() {
+  cout << "====== DICTIONARY 340 C++ =====\n";
+  cout << "------ Dictionaries: " << dictionaries.size() << "\n";
+  cout << "       Start a search with '@name' to search another dictionary,"
+          "\n";
+  cout << "       or enter '!dictionaries' to list them.\n\n";
+}
+
+void DictionaryHost::printUnknownDictionary(const string &name) {
+  cout << "<!>ERROR<!> ===>" << ' ' << "Unknown dictionary: " << name << "\n";
+  cout << "<!>ERROR<!> ===>" << ' ' << "Dictionaries:";
+  for (auto &named : dictionaries) {
+    cout << ' ' << named.first;
+  }
+  cout << "\n";
+}
+
+void DictionaryHost::printLoadError(HostedDictionary &hosted) {
+  cout << "<!>ERROR<!> ===>" << ' ' << "File could not be opened."
+       << "\n";
+  cout << "<!>ERROR<!> ===>" << ' ' << "Dictionary " << hosted.name
+       << " has file path:" << ' ' << hosted.path << "\n";
+}
+
+/** ---END:-------- PRINT HELPER METHODS ------------------------- */
@@ -0,0 +1,80 @@
+/**
+ * File:        DictionaryHost.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  that serve searches from many interactive dictionaries, loading
+ *  each when it is first searched and evicting the least recently
+ *  used ones to stay within a memory budget.
+ */
+
+#ifndef DICTIONARYHOST_H
+#define DICTIONARYHOST_H
+
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "InteractiveDictionary.h"
+
+class DictionaryHost {
+public:
+  static const std::size_t NO_BUDGET = static_cast<std::size_t>(-1);
+
+  explicit DictionaryHost(std::size_t memoryBudgetBytes = NO_BUDGET);
+
+  bool registerDictionary(const std::string &name, const std::string &path);
+  void read();
+  void printMetrics(std::ostream &out);
+
+private:
+  /**
+   * @brief   A registered data file, and its dictionary while it is
+   *          loaded.
+   */
+  struct HostedDictionary {
+    std::string name;
+    std::string path;
+    std::unique_ptr<InteractiveDictionary> dictionary;
+    std::list<HostedDictionary *>::iterator recentUse;
+    std::size_t loads{0};
+    std::size_t evictions{0};
+    double loadSeconds{0};
+  };
+
+  std::size_t memoryBudget;
+  std::map<std::string, HostedDictionary> dictionaries;
+  /** The loaded dictionaries, the most recently used first. */
+  std::list<HostedDictionary *> recentlyUsed;
+  HostedDictionary *current{nullptr};
+
+  std::size_t searches{0};
+  std::size_t loads{0};
+  std::size_t reloads{0};
+  std::size_t evictions{0};
+  std::size_t evictedBytes{0};
+  double loadSeconds{0};
+
+  InteractiveDictionary *use(HostedDictionary &);
+  bool load(HostedDictionary &);
+  void evict(HostedDictionary &);
+  void evictUntilWithinBudget();
+  std::size_t getResidentBytes();
+
+  bool selectDictionary(std::string &searchQuery);
+  bool isQuit(std::string &searchQuery);
+  bool isMetricsReport(std::string &searchQuery);
+
+  void printIntroduction();
+  void printUnknownDictionary(const std::string &name);
+  void printLoadError(HostedDictionary &);
+};
+
+#endif // DICTIONARYHOST_H
@@ -0,0 +1,124 @@
+/**
+ * File:        ExportPipeline.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  that format chunks of output on many threads and write them
+ *  to a file in order.
+ */
+
+#include "ExportPipeline.h"
+
+#include <algorithm>
+#include <thread>
+
+using std::size_t;
+using std::unique_lock;
+using std::vector;
+
+const unsigned ExportPipeline::MAX_THREADS;
+
+/**
+ * @brief Constructs a pipeline with the given number of formatting
+ *        threads, from 1 to MAX_THREADS, whose chunk buffers take memory
+ *        from the resource.
+ */
+ExportPipeline::ExportPipeline(unsigned threadCount, MemoryResource *resource)
+    : threadCount(std::max(1u, std::min(threadCount, MAX_THREADS))) {
+  size_t slotCount = this->threadCount * CHUNKS_PER_THREAD;
+  slots.reserve(slotCount);
+  for (size_t i = 0; i < slotCount; i++) {
+    slots.push_back(Slot{
+        AccountedString(AccountingAllocator<char>(resource)), 0, false});
+  }
+}
+
+/**
+ * @brief Formats chunks 0 to chunkCount - 1 and writes them to out in
+ *        that order. Returns false if a write failed.
+ */
+bool ExportPipeline::run(size_t chunkCount, const ChunkFormatter &formatChunk,
+                         std::FILE *out) {
+  nextChunk = 0;
+  chunksWritten = 0;
+  bytesWritten = 0;
+  hasFailed = false;
+
+  vector<std::thread> workers;
+  for (unsigned i = 0; i < threadCount; i++) {
+    workers.emplace_back(&ExportPipeline::format, this, chunkCount,
+                         std::cref(formatChunk));
+  }
+
+  for (size_t chunk = 0; chunk < chunkCount && !hasFailed; chunk++) {
+    Slot &slot = slots[chunk % slots.size()];
+    {
+      unique_lock<std::mutex> lock(mutex);
+      chunkFormatted.wait(lock, [&slot, chunk] {
+        return slot.isReady && slot.chunk == chunk;
+      });
+    }
+
+    // The slot is the writer's until it is marked as not ready.
+    size_t written = std::fwrite(slot.text.data(), 1, slot.text.size(), out);
+    bytesWritten += written;
+
+    {
+      unique_lock<std::mutex> lock(mutex);
+      slot.isReady = false;
+      ++chunksWritten;
+      if (written != slot.text.size()) {
+        hasFailed = true;
+        nextChunk = chunkCount;
+      }
+    }
+    chunkWritten.notify_all();
+  }
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  return !hasFailed && std::fflush(out) == 0;
+}
+
+size_t ExportPipeline::getBytesWritten() const { return bytesWritten; }
+
+/**
+ * @brief Takes the next chunk, waits until its slot has been written,
+ *        then formats the chunk into the slot. Runs on every worker.
+ */
+void ExportPipeline::format(size_t chunkCount,
+                            const ChunkFormatter &formatChunk) {
+  while (true) {
+    size_t chunk;
+    Slot *slot;
+    {
+      unique_lock<std::mutex> lock(mutex);
+      if (nextChunk >= chunkCount) {
+        return;
+      }
+      chunk = nextChunk++;
+      slot = &slots[chunk % slots.size()];
+      chunkWritten.wait(lock, [this, chunk] {
+        return chunk < chunksWritten + slots.size() || hasFailed;
+      });
+      if (hasFailed) {
+        return;
+      }
+    }
+
+    slot->text.clear();
+    formatChunk(chunk, slot->text);
+
+    {
+      unique_lock<std::mutex> lock(mutex);
+      slot->chunk = chunk;
+      slot->isReady = true;
+    }
+    chunkFormatted.notify_all();
+  }
+}
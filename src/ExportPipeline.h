@@ -0,0 +1,72 @@
+/**
+ * File:        ExportPipeline.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  that format chunks of output on many threads and write them
+ *  to a file in order.
+ */
+
+#ifndef EXPORTPIPELINE_H
+#define EXPORTPIPELINE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "MemoryAccounting.h"
+
+/**
+ * @brief   Formats numbered chunks on worker threads while the calling
+ *          thread writes the finished chunks in order, one large write
+ *          each. Only a window of chunks is formatted ahead of the writer,
+ *          so memory stays bounded however large the output is.
+ */
+class ExportPipeline {
+public:
+  typedef std::function<void(std::size_t chunk, AccountedString &out)>
+      ChunkFormatter;
+
+  static const unsigned MAX_THREADS = 256;
+
+  ExportPipeline(unsigned threadCount, MemoryResource *resource);
+
+  bool run(std::size_t chunkCount, const ChunkFormatter &formatChunk,
+           std::FILE *out);
+
+  std::size_t getBytesWritten() const;
+
+private:
+  static const std::size_t CHUNKS_PER_THREAD = 4;
+
+  /**
+   * @brief   A buffer for one chunk in the window. A chunk goes in slot
+   *          (chunk % window size).
+   */
+  struct Slot {
+    AccountedString text;
+    std::size_t chunk;
+    bool isReady;
+  };
+
+  unsigned threadCount;
+  std::vector<Slot> slots;
+  std::mutex mutex;
+  std::condition_variable chunkFormatted;
+  std::condition_variable chunkWritten;
+  std::size_t nextChunk{0};
+  std::size_t chunksWritten{0};
+  std::size_t bytesWritten{0};
+  bool hasFailed{false};
+
+  void format(std::size_t chunkCount, const ChunkFormatter &formatChunk);
+};
+
+#endif // EXPORTPIPELINE_H
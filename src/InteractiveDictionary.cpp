@@ -17,150 +17,445 @@
 
 using std::cin;
 using std::cout;
-using std::deque;
-using std::istream_iterator;
-using std::istringstream;
 using std::map;
 using std::ostringstream;
+using std::size_t;
 using std::sort;
 using std::string;
 using std::vector;
+using std::chrono::steady_clock;
 
 /**
- * @brief Serves the client.
+ * @brief Constructs an interactive dictionary whose printed entries are
+ *        accounted as output memory.
+ */
+InteractiveDictionary::InteractiveDictionary()
+    : outputBuffer(AccountingAllocator<char>(&outputMemory)) {}
+
+/**
+ * @brief Serves the client until they quit or their input ends. Searches
+ *        are written to the session log, if one was opened.
  */
 void InteractiveDictionary::read() {
   populateWithData();
   printIntroduction(uniqueKeywords, definitions);
 
   int searchCount{0};
-  string searchQuery{};
+  AccountedString searchQuery{AccountingAllocator<char>(&queryMemory)};
   while (true) {
     ++searchCount;
     printSearchNumber(searchCount);
 
-    getline(cin, searchQuery);
-
-    vector<string> parsedSearchQuery = parseSearchQuery(searchQuery);
-
-    if (!isValid(parsedSearchQuery.size())) {
-      printManual();
-      continue;
+    if (!getline(cin, searchQuery)) {
+      break;
+    }
+    if (sessionRecorder.isOpen()) {
+      sessionRecorder.record(searchQuery);
     }
 
-    string entryWord = parsedSearchQuery.front();
-    if (isQuit(entryWord)) {
-      printThankYou();
+    if (!respond(searchQuery)) {
       break;
     }
-    if (isHelp(entryWord)) {
-      printManual();
-      continue;
+  }
+}
+
+/**
+ * @brief Looks up every whitespace-separated word of a stream, many at a
+ *        time, and prints each keyword with its number of entries (0 if
+ *        it is missing) on a tab-separated line. Then prints how fast the
+ *        lookups were.
+ */
+void InteractiveDictionary::lookupBatch(std::istream &words) {
+  AccountingAllocator<char> queryAllocator(&queryMemory);
+  vector<AccountedString, AccountingAllocator<AccountedString>> keywords(
+      LOOKUP_BATCH_SIZE, AccountedString(queryAllocator), queryAllocator);
+  vector<const Entries *, AccountingAllocator<const Entries *>> found(
+      LOOKUP_BATCH_SIZE, nullptr, queryAllocator);
+
+  size_t wordCount = 0;
+  size_t foundCount = 0;
+  steady_clock::duration lookupTime(0);
+  bool hasWords = true;
+  while (hasWords) {
+    size_t batchSize = 0;
+    while (batchSize < LOOKUP_BATCH_SIZE && words >> keywords[batchSize]) {
+      standardizeKeyword(keywords[batchSize]);
+      ++batchSize;
     }
-    if (!isValid(entryWord)) {
-      printNotFound();
-      printManual();
-      continue;
+    hasWords = batchSize == LOOKUP_BATCH_SIZE;
+
+    steady_clock::time_point start = steady_clock::now();
+    findEntries(keywords.data(), batchSize, found.data());
+    lookupTime += steady_clock::now() - start;
+
+    outputBuffer.clear();
+    for (size_t i = 0; i < batchSize; i++) {
+      size_t entryCount = countEntries(keywords[i], found[i]);
+      foundCount += (entryCount == 0) ? 0 : 1;
+      outputBuffer += keywords[i];
+      outputBuffer += '\t';
+      outputBuffer += std::to_string(entryCount).c_str();
+      outputBuffer += '\n';
     }
+    cout.write(outputBuffer.data(), outputBuffer.size());
+    wordCount += batchSize;
+  }
+
+  printLookupReport(wordCount, foundCount,
+                    std::chrono::duration<double>(lookupTime).count());
+}
+
+/**
+ * @brief Starts writing every search to a session log. Returns false if
+ *        the log could not be opened.
+ */
+bool InteractiveDictionary::recordSession(const string &logPath) {
+  return sessionRecorder.open(logPath);
+}
 
-    vector<Entry> entries = entriesBatch.at(entryWord);
+/**
+ * @brief Replays the searches of a session log against this dictionary
+ *        and prints their latencies. At the recorded pace, or with a
+ *        positive number of queries per second, searches are started on a
+ *        fixed schedule (open loop), and a search's latency counts from
+ *        when it should have started. Otherwise each search starts as soon
+ *        as the previous one ends (closed loop). Recorded edits change the loaded entries only:
+ *        they are neither logged nor compacted into the data file.
+ */
+void InteractiveDictionary::replay(const vector<RecordedQuery> &queries,
+                                   double queriesPerSecond,
+                                   bool isRecordedPace) {
+  populateWithData();
+  areEditsSaved = false;
+  printIntroduction(uniqueKeywords, definitions);
 
-    modifyEntries(entries, parsedSearchQuery);
+  AccountedString searchQuery{AccountingAllocator<char>(&queryMemory)};
+  LatencyHistogram latencies;
+  bool isOpenLoop = isRecordedPace || queriesPerSecond > 0;
+  std::chrono::nanoseconds interval(
+      (queriesPerSecond > 0) ? static_cast<long long>(1e9 / queriesPerSecond)
+                             : 0);
+  std::chrono::microseconds recordedOffset(0);
+
+  NullBuffer nullBuffer;
+  std::streambuf *coutBuffer = cout.rdbuf(&nullBuffer);
+  steady_clock::time_point start = steady_clock::now();
+  for (size_t i = 0; i < queries.size(); i++) {
+    recordedOffset += std::chrono::microseconds(queries[i].delayMicroseconds);
+    steady_clock::time_point scheduled = start + interval * i;
+    if (isRecordedPace) {
+      scheduled = start + recordedOffset;
+    }
+    if (isOpenLoop) {
+      // Sleeping can overshoot, so the last stretch is spent spinning.
+      std::this_thread::sleep_until(scheduled - std::chrono::microseconds(200));
+      while (steady_clock::now() < scheduled) {
+      }
+    } else {
+      scheduled = steady_clock::now();
+    }
 
-    printEntries(entries);
+    searchQuery.assign(queries[i].searchQuery.data(),
+                       queries[i].searchQuery.size());
+    respond(searchQuery);
 
-    continue;
+    latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         steady_clock::now() - scheduled)
+                         .count());
   }
+  double seconds =
+      std::chrono::duration<double>(steady_clock::now() - start).count();
+  cout.rdbuf(coutBuffer);
+
+  printReplayReport(latencies, seconds, queriesPerSecond, isRecordedPace);
+}
+
+/**
+ * @brief Responds to one search. Everything a search needs is taken from
+ *        the query arena, which is emptied first. Returns false if the
+ *        client wants to quit.
+ */
+bool InteractiveDictionary::respond(AccountedString &searchQuery) {
+  queryArena.reset();
+  finishCompaction(false);
+
+  QueryTokens parsedSearchQuery = parseSearchQuery(searchQuery);
+  if (!parsedSearchQuery.empty() && isLookup(parsedSearchQuery.front())) {
+    printLookups(parsedSearchQuery);
+    return true;
+  }
+  if (!parsedSearchQuery.empty() && isEdit(parsedSearchQuery.front())) {
+    edit(searchQuery, parsedSearchQuery.front());
+    return true;
+  }
+  QueryResult result = makeQueryResult();
+  takePage(result, parsedSearchQuery);
+
+  if (!isValid(parsedSearchQuery.size())) {
+    printManual();
+    return true;
+  }
+
+  AccountedString &entryWord = parsedSearchQuery.front();
+  if (isQuit(entryWord)) {
+    printThankYou();
+    return false;
+  }
+  if (isHelp(entryWord)) {
+    printManual();
+    return true;
+  }
+  if (isMissReport(entryWord)) {
+    printMisses();
+    return true;
+  }
+  if (KeywordPatternIndex::isPattern(entryWord)) {
+    printMatchingKeywords(result, entryWord);
+    return true;
+  }
+  if (!isValid(entryWord)) {
+    missedKeywords.record(entryWord.data(), entryWord.size());
+    printNotFound();
+    printManual();
+    return true;
+  }
+
+  viewEntries(result, entryWord);
+
+  modifyEntries(result, parsedSearchQuery);
+
+  printEntries(result);
+
+  return true;
 }
 
 /**
  * @brief Modifies entries by filtering and sorting entries with given queries,
  *        and prints errors if the queries are not any of the modifiers.
  */
-void InteractiveDictionary::modifyEntries(vector<Entry> &entries,
-                                          vector<string> &parsedSearchQuery) {
-  sortInOrder(entries);
+void InteractiveDictionary::modifyEntries(QueryResult &result,
+                                          QueryTokens &parsedSearchQuery) {
+  sortInOrder(result);
   if (parsedSearchQuery.size() == 1) {
     return;
   }
 
-  deque<string> errorModifierMessage{OFFSET, ERROR_PART_OF_SPEECH,
-                                     ERROR_DISTINCT, ERROR_REVERSE};
-  deque<string> modifiers{OFFSET, PART_OF_SPEECH, DISTINCT, REVERSE};
-  for (int parameterIndex = 1; parameterIndex < parsedSearchQuery.size();
+  for (size_t parameterIndex = 1; parameterIndex < parsedSearchQuery.size();
        parameterIndex++) {
-    modifiers.pop_front();
-    errorModifierMessage.pop_front();
-
-    string parameter = parsedSearchQuery.at(parameterIndex);
+    AccountedString &parameter = parsedSearchQuery.at(parameterIndex);
     int parameterNumber = parameterIndex + 1;
-    if (!isAvailableModifier(modifiers, parameter, parameterNumber)) {
-      printParameterErrors(errorModifierMessage, parameter, parameterNumber);
+    if (!isAvailableModifier(parameterIndex, parameter, parameterNumber)) {
+      printParameterErrors(parameterIndex, parameter, parameterNumber);
       continue;
     }
     if (parameter == REVERSE) {
-      sortInReverseOrder(entries);
+      sortInReverseOrder(result);
     } else if (parameter == DISTINCT) {
-      filterByDistinctEntries(entries);
+      filterByDistinctEntries(result);
     } else if (isPartOfSpeech(parameter)) {
-      if (!entriesHavePartOfSpeech(entries, parameter)) {
-        entries.front().exists = false;
+      if (!entriesHavePartOfSpeech(result, parameter)) {
+        result.isFound = false;
         continue;
       }
-      filterByPartOfSpeech(entries, parameter);
+      filterByPartOfSpeech(result, parameter);
     }
   }
 }
 
+/**
+ * @brief Returns an empty result, showing every entry, whose views live
+ *        in the query arena.
+ */
+InteractiveDictionary::QueryResult InteractiveDictionary::makeQueryResult() {
+  return QueryResult{EntryViews(EntryViews::allocator_type(&queryArena)), 0,
+                     NO_LIMIT, true};
+}
+
+/**
+ * @brief Makes a result view the entries shown for a keyword, without
+ *        copying them.
+ */
+void InteractiveDictionary::viewEntries(QueryResult &result,
+                                        AccountedString &entryWord) {
+  collectEntries(entryWord, result.entries);
+}
+
+/**
+ * @brief Adds or deletes senses, or compacts the edits, as asked by a
+ *        search starting with '!add', '!delete' or '!compact'. The search
+ *        is split again so that definitions keep their letter case.
+ */
+void InteractiveDictionary::edit(AccountedString &searchQuery,
+                                 AccountedString &command) {
+  QueryTokens tokens = getTokens(searchQuery);
+  if (command == COMPACT) {
+    printCompaction(tokens.size() == 1 && startCompaction());
+    return;
+  }
+
+  bool isAdd = command == ADD;
+  size_t minimumTokens = isAdd ? 4 : 2;
+  if (tokens.size() < minimumTokens ||
+      KeywordPatternIndex::isPattern(tokens[1]) ||
+      tokens[1].find('|') != AccountedString::npos) {
+    printEditError();
+    return;
+  }
+  AccountedString *partOfSpeech = nullptr;
+  if (tokens.size() > 2) {
+    partOfSpeech = &tokens[2];
+    lowerCaseAllLettersOf(*partOfSpeech);
+    if (!isPartOfSpeech(*partOfSpeech)) {
+      printEditError();
+      return;
+    }
+  }
+  AccountedString *definition = nullptr;
+  if (tokens.size() > 3) {
+    definition = &tokens[3];
+    for (size_t i = 4; i < tokens.size(); i++) {
+      *definition += ' ';
+      *definition += tokens[i];
+    }
+    if (definition->find('|') != AccountedString::npos) {
+      printEditError();
+      return;
+    }
+  }
+
+  if (isAdd) {
+    bool isAdded = addSense(tokens[1], *partOfSpeech, *definition);
+    printAdded(tokens[1], *partOfSpeech, *definition, isAdded);
+  } else {
+    printDeleted(tokens[1], deleteSenses(tokens[1], partOfSpeech, definition));
+  }
+}
+
+/**
+ * @brief Takes the optional 'limit N' and 'offset M' parameters out of a
+ *        search query, wherever they are after the search key, and keeps
+ *        them in the result. The other parameters keep their positions.
+ */
+void InteractiveDictionary::takePage(QueryResult &result,
+                                     QueryTokens &parsedSearchQuery) {
+  size_t parameterIndex = 1;
+  while (parameterIndex < parsedSearchQuery.size()) {
+    AccountedString &parameter = parsedSearchQuery.at(parameterIndex);
+    if (!(parameter == LIMIT) && !(parameter == OFFSET)) {
+      ++parameterIndex;
+      continue;
+    }
+
+    bool hasNumber = parameterIndex + 1 < parsedSearchQuery.size() &&
+                     isNumber(parsedSearchQuery.at(parameterIndex + 1));
+    if (!hasNumber) {
+      printPageError(parameter);
+      parsedSearchQuery.erase(parsedSearchQuery.begin() + parameterIndex);
+      continue;
+    }
+
+    size_t number = std::strtoul(
+        parsedSearchQuery.at(parameterIndex + 1).c_str(), nullptr, 10);
+    if (parameter == LIMIT) {
+      result.limit = number;
+    } else {
+      result.offset = number;
+    }
+    parsedSearchQuery.erase(parsedSearchQuery.begin() + parameterIndex,
+                            parsedSearchQuery.begin() + parameterIndex + 2);
+  }
+}
+
 /** ---START:----- MODIFY ENTRIES - FILTER/SORTING HELPER METHODS ------------*/
 
 /**
  * @brief Sorts the specified entries in alphabetical order,
  *        first by part of speech then by definition.
  */
-void InteractiveDictionary::sortInOrder(vector<Entry> &entries) {
-  sort(entries.begin(), entries.end(), [](Entry &s1, Entry &s2) {
-    return ((s1.partOfSpeech + s1.definition) <
-            (s2.partOfSpeech + s2.definition));
-  });
+void InteractiveDictionary::sortInOrder(QueryResult &result) {
+  sort(result.entries.begin(), result.entries.end(),
+       [](const Entry *s1, const Entry *s2) {
+         return compareInOrder(*s1, *s2) < 0;
+       });
 }
 
 /**
  * @brief Removes the entries' part of speech that doesn't match the
  *        specifed part of speech.
  */
-void InteractiveDictionary::filterByPartOfSpeech(vector<Entry> &entries,
-                                                 string &partOfSpeech) {
-  for (int i = entries.size() - 1; i >= 0; i--) {
-    if (!(entries.at(i).partOfSpeech == partOfSpeech)) {
-      entries.erase(entries.begin() + i);
-    }
-  }
+void InteractiveDictionary::filterByPartOfSpeech(
+    QueryResult &result, AccountedString &partOfSpeech) {
+  EntryViews &entries = result.entries;
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [&partOfSpeech](const Entry *entry) {
+                                 return !(entry->partOfSpeech == partOfSpeech);
+                               }),
+                entries.end());
 }
 
 /**
- * @brief Gets rid of duplicate entries.
+ * @brief Gets rid of duplicate entries. Entries are sorted by now, so a
+ *        duplicate can only be among the entries just before it that
+ *        sort the same.
  */
-void InteractiveDictionary::filterByDistinctEntries(vector<Entry> &entries) {
-  map<string, int> visitedEntry;
-
-  for (int i = entries.size() - 1; i >= 0; i--) {
-    if (visitedEntry.find(entries.at(i).toString()) != visitedEntry.end()) {
-      entries.erase(entries.begin() + i);
+void InteractiveDictionary::filterByDistinctEntries(QueryResult &result) {
+  EntryViews &entries = result.entries;
+  EntryViews::iterator distinctEnd = entries.begin();
+  for (EntryViews::iterator entry = entries.begin();
+       entry != entries.end(); ++entry) {
+    bool isDuplicate = false;
+    for (EntryViews::iterator kept = distinctEnd;
+         kept != entries.begin();) {
+      --kept;
+      if (compareInOrder(**kept, **entry) != 0) {
+        break;
+      }
+      if ((*kept)->word == (*entry)->word &&
+          (*kept)->partOfSpeech == (*entry)->partOfSpeech &&
+          (*kept)->definition == (*entry)->definition) {
+        isDuplicate = true;
+        break;
+      }
+    }
+    if (!isDuplicate) {
+      *distinctEnd++ = *entry;
     }
-    visitedEntry[entries.at(i).toString()] = 1;
   }
+  entries.erase(distinctEnd, entries.end());
 }
 
 /**
  * @brief Sorts the specified entries in reverse-alphabetical order,
  *        first by part of speech then by definition.
  */
-void InteractiveDictionary::sortInReverseOrder(vector<Entry> &entries) {
-  sort(entries.begin(), entries.end(), [](Entry &s1, Entry &s2) {
-    return ((s1.partOfSpeech + s1.definition) >
-            (s2.partOfSpeech + s2.definition));
-  });
+void InteractiveDictionary::sortInReverseOrder(QueryResult &result) {
+  sort(result.entries.begin(), result.entries.end(),
+       [](const Entry *s1, const Entry *s2) {
+         return compareInOrder(*s1, *s2) > 0;
+       });
+}
+
+/**
+ * @brief Compares two entries by their part of speech followed by their
+ *        definition, as if both were joined into one string, without
+ *        joining them.
+ */
+int InteractiveDictionary::compareInOrder(const Entry &s1, const Entry &s2) {
+  size_t length1 = s1.partOfSpeech.size() + s1.definition.size();
+  size_t length2 = s2.partOfSpeech.size() + s2.definition.size();
+  size_t length = std::min(length1, length2);
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c1 = (i < s1.partOfSpeech.size())
+                           ? s1.partOfSpeech[i]
+                           : s1.definition[i - s1.partOfSpeech.size()];
+    unsigned char c2 = (i < s2.partOfSpeech.size())
+                           ? s2.partOfSpeech[i]
+                           : s2.definition[i - s2.partOfSpeech.size()];
+    if (c1 != c2) {
+      return (c1 < c2) ? -1 : 1;
+    }
+  }
+  return (length1 < length2) ? -1 : (length1 > length2) ? 1 : 0;
 }
 
 /** ---END:------- MODIFY ENTRIES - FILTER/SORTING HELPER METHODS --- -*/
@@ -171,15 +466,16 @@ void InteractiveDictionary::sortInReverseOrder(vector<Entry> &entries) {
  * @brief Returns a string vector out of the search query's white-space
  *        separated values.
  */
-vector<string> InteractiveDictionary::parseSearchQuery(string &seachQuery) {
-  vector<string> tokens = getTokens(seachQuery);
+InteractiveDictionary::QueryTokens
+InteractiveDictionary::parseSearchQuery(AccountedString &seachQuery) {
+  QueryTokens tokens = getTokens(seachQuery);
 
-  for (string &token : tokens) {
+  for (AccountedString &token : tokens) {
     lowerCaseAllLettersOf(token);
   }
 
   if (!tokens.empty()) {
-    capitalizeFirstLetterOf(tokens.front());
+    standardizeKeyword(tokens.front());
   }
 
   return tokens;
@@ -187,13 +483,14 @@ vector<string> InteractiveDictionary::parseSearchQuery(string &seachQuery) {
 
 /**
  * @brief Returns true if the specified parameter is a search query that
- *        can be used to filter or sort entries.
+ *        can be used to filter or sort entries. Modifiers before the
+ *        parameter's position are no longer available.
  */
-bool InteractiveDictionary::isAvailableModifier(deque<string> &modifiers,
-                                                string &parameter,
+bool InteractiveDictionary::isAvailableModifier(size_t firstModifier,
+                                                AccountedString &parameter,
                                                 int &parameterNumber) {
-  for (string modifier : modifiers) {
-    if (parameter == modifier) {
+  for (size_t i = firstModifier; i < MODIFIER_COUNT; i++) {
+    if (parameter == *MODIFIERS[i]) {
       return true;
     }
   }
@@ -205,10 +502,10 @@ bool InteractiveDictionary::isAvailableModifier(deque<string> &modifiers,
   return false;
 }
 
-bool InteractiveDictionary::entriesHavePartOfSpeech(vector<Entry> &entries,
-                                                    string &partOfSpeech) {
-  for (Entry entry : entries) {
-    if (entry.partOfSpeech == partOfSpeech) {
+bool InteractiveDictionary::entriesHavePartOfSpeech(
+    QueryResult &result, AccountedString &partOfSpeech) {
+  for (const Entry *entry : result.entries) {
+    if (entry->partOfSpeech == partOfSpeech) {
       return true;
     }
   }
@@ -216,30 +513,56 @@ bool InteractiveDictionary::entriesHavePartOfSpeech(vector<Entry> &entries,
   return false;
 }
 
-bool InteractiveDictionary::isPartOfSpeech(string &parameter) {
+bool InteractiveDictionary::isNumber(AccountedString &parameter) {
+  return !parameter.empty() &&
+         std::all_of(parameter.begin(), parameter.end(),
+                     [](char c) {
+                       return std::isdigit(static_cast<unsigned char>(c));
+                     });
+}
+
+bool InteractiveDictionary::isPartOfSpeech(AccountedString &parameter) {
   return (partOfSpeechMap.find(parameter) != partOfSpeechMap.end());
 }
 
 /**
  * @brief Creates vector elements out of the specified search query's
- *        white-space separated elements
+ *        white-space separated elements, in the query arena.
  */
-vector<string> InteractiveDictionary::getTokens(string &searchQuery) {
-  istringstream iss(searchQuery);
-  vector<string> tokens{istream_iterator<string>{iss},
-                        istream_iterator<string>{}};
+InteractiveDictionary::QueryTokens
+InteractiveDictionary::getTokens(AccountedString &searchQuery) {
+  QueryTokens tokens{QueryTokens::allocator_type(&queryArena)};
+  size_t i = 0;
+  while (i < searchQuery.size()) {
+    while (i < searchQuery.size() &&
+           std::isspace(static_cast<unsigned char>(searchQuery[i]))) {
+      ++i;
+    }
+    size_t tokenStart = i;
+    while (i < searchQuery.size() &&
+           !std::isspace(static_cast<unsigned char>(searchQuery[i]))) {
+      ++i;
+    }
+    if (i > tokenStart) {
+      tokens.emplace_back(searchQuery, tokenStart, i - tokenStart,
+                          tokens.get_allocator());
+    }
+  }
   return tokens;
 }
 
-bool InteractiveDictionary::isHelp(string &entryWord) {
+bool InteractiveDictionary::isHelp(AccountedString &entryWord) {
   return entryWord == "!help";
 }
 
 /**
  * @brief Returns true if the entry word exists in this dictionary.
+ *        Most missing words are rejected by the keyword filter
+ *        before the entries are walked.
  */
-bool InteractiveDictionary::isValid(string &entryWord) {
-  return (entriesBatch.find(entryWord) != entriesBatch.end());
+bool InteractiveDictionary::isValid(AccountedString &entryWord) {
+  return keywordFilter.mightContain(entryWord.data(), entryWord.size()) &&
+         hasEntries(entryWord);
 }
 
 /**
@@ -249,10 +572,22 @@ bool InteractiveDictionary::isValid(size_t searchQuerySize) {
   return (searchQuerySize > 0 && searchQuerySize < 5);
 }
 
-bool InteractiveDictionary::isQuit(string &entryWord) {
+bool InteractiveDictionary::isQuit(AccountedString &entryWord) {
   return (entryWord == "!q");
 }
 
+bool InteractiveDictionary::isEdit(AccountedString &entryWord) {
+  return (entryWord == ADD || entryWord == DELETE || entryWord == COMPACT);
+}
+
+bool InteractiveDictionary::isLookup(AccountedString &entryWord) {
+  return (entryWord == "!lookup");
+}
+
+bool InteractiveDictionary::isMissReport(AccountedString &entryWord) {
+  return (entryWord == "!misses");
+}
+
 /**
  * @brief Returns what a number's given position is in a series,
  *        for example: 1 is 1st, 2 is 2nd, etc.
@@ -269,15 +604,16 @@ string InteractiveDictionary::getOrdinalNumber(int &number) {
  * @brief Prints the position of the incorrect search query the user typed
  *        in trying to modify entries, with help in what they should have been.
  */
-void InteractiveDictionary::printParameterErrors(deque<string> &modifiers,
-                                                 string &parameter,
+void InteractiveDictionary::printParameterErrors(size_t firstModifier,
+                                                 AccountedString &parameter,
                                                  int &parameterNumber) {
   ostringstream oss;
   string ordinalNumber{getOrdinalNumber(parameterNumber)};
   cout << "       |\n";
-  int orTimes = modifiers.size();
+  int orTimes = MODIFIER_COUNT - firstModifier;
 
-  for (string modifier : modifiers) {
+  for (size_t i = firstModifier; i < MODIFIER_COUNT; i++) {
+    const string &modifier = *ERROR_MODIFIER_MESSAGES[i];
     cout << "        <The entered " << ordinalNumber << " parameter "
          << "'" << parameter << "' is NOT " << modifier << ".>\n";
 
@@ -293,23 +629,182 @@ void InteractiveDictionary::printParameterErrors(deque<string> &modifiers,
 /**
  * @brief Prints the contents of the specified entries if it exists,
  *        otherwise tells user that it wasn't found and
- *        how to use this dictionary.
+ *        how to use this dictionary. Only the requested page of entries
+ *        is printed, gathered in the output buffer and written at once.
  */
-void InteractiveDictionary::printEntries(vector<Entry> &entries) {
-  if (!entries.front().exists) {
+void InteractiveDictionary::printEntries(QueryResult &result) {
+  if (!result.isFound) {
     printNotFound();
     printManual();
     return;
   }
 
+  size_t total = result.entries.size();
+  size_t first = std::min(result.offset, total);
+  size_t last = (result.limit < total - first) ? first + result.limit : total;
+
+  outputBuffer.clear();
+  outputBuffer += "       |\n";
+  for (size_t i = first; i < last; i++) {
+    result.entries[i]->appendTo(outputBuffer);
+    outputBuffer += '\n';
+  }
+  cout.write(outputBuffer.data(), outputBuffer.size());
+  if ((result.offset != 0 || result.limit != NO_LIMIT) && first == last) {
+    cout << "        <Showing none of " << total << " entries.>\n";
+  } else if (result.offset != 0 || result.limit != NO_LIMIT) {
+    cout << "        <Showing " << first + 1 << "-" << last << " of " << total
+         << " entries.>\n";
+  }
   cout << "       |\n";
-  ostringstream oss;
-  for (Entry entry : entries) {
-    cout << entry.toString() << "\n";
+}
+
+/**
+ * @brief Prints the page of keywords that match a wildcard pattern,
+ *        where '?' is any one character and '*' is any characters.
+ */
+void InteractiveDictionary::printMatchingKeywords(QueryResult &result,
+                                                  AccountedString &pattern) {
+  KeywordPatternIndex::Keywords matches{
+      KeywordPatternIndex::Keywords::allocator_type(&queryArena)};
+  matchKeywords(pattern, matches);
+  if (matches.empty()) {
+    printNotFound();
+    return;
+  }
+
+  size_t total = matches.size();
+  size_t first = std::min(result.offset, total);
+  size_t last = (result.limit < total - first) ? first + result.limit : total;
+
+  outputBuffer.clear();
+  outputBuffer += "       |\n";
+  for (size_t i = first; i < last; i++) {
+    outputBuffer += "        ";
+    outputBuffer += *matches[i];
+    outputBuffer += '\n';
+  }
+  cout.write(outputBuffer.data(), outputBuffer.size());
+  const char *matching =
+      (total == 1) ? " keyword that matches '" : " keywords that match '";
+  if ((result.offset != 0 || result.limit != NO_LIMIT) && first == last) {
+    cout << "        <Showing none of " << total << matching << pattern
+         << "'.>\n";
+  } else if (result.offset != 0 || result.limit != NO_LIMIT) {
+    cout << "        <Showing " << first + 1 << "-" << last << " of " << total
+         << matching << pattern << "'.>\n";
+  } else {
+    cout << "        <" << total
+         << ((total == 1) ? " keyword matches '" : " keywords match '")
+         << pattern << "'.>\n";
+  }
+  cout << "       |\n";
+}
+
+/**
+ * @brief Prints how many entries each keyword after '!lookup' has. The
+ *        keywords are looked up together, as a batch.
+ */
+void InteractiveDictionary::printLookups(QueryTokens &parsedSearchQuery) {
+  size_t keywordCount = parsedSearchQuery.size() - 1;
+  AccountedString *keywords = parsedSearchQuery.data() + 1;
+  vector<const Entries *, AccountingAllocator<const Entries *>> found(
+      keywordCount, nullptr,
+      AccountingAllocator<const Entries *>(&queryArena));
+  for (size_t i = 0; i < keywordCount; i++) {
+    capitalizeFirstLetterOf(keywords[i]);
+  }
+  findEntries(keywords, keywordCount, found.data());
+
+  outputBuffer.clear();
+  outputBuffer += "       |\n";
+  for (size_t i = 0; i < keywordCount; i++) {
+    outputBuffer += "        ";
+    outputBuffer += keywords[i];
+    size_t entryCount = countEntries(keywords[i], found[i]);
+    if (entryCount == 0) {
+      missedKeywords.record(keywords[i].data(), keywords[i].size());
+      outputBuffer += " : <NOT FOUND>\n";
+    } else {
+      outputBuffer += " : ";
+      outputBuffer += std::to_string(entryCount).c_str();
+      outputBuffer += (entryCount == 1) ? " entry\n" : " entries\n";
+    }
+  }
+  outputBuffer += "       |\n";
+  cout.write(outputBuffer.data(), outputBuffer.size());
+}
+
+void InteractiveDictionary::printAdded(AccountedString &keyword,
+                                       AccountedString &partOfSpeech,
+                                       AccountedString &definition,
+                                       bool isAdded) {
+  cout << "       |\n";
+  cout << "        <" << (isAdded ? "ADDED" : "ALREADY THERE") << "> "
+       << keyword << " [" << partOfSpeech << "] : " << definition << "\n";
+  cout << "       |\n";
+}
+
+void InteractiveDictionary::printDeleted(AccountedString &keyword,
+                                         size_t deletedCount) {
+  cout << "       |\n";
+  if (deletedCount == 0) {
+    cout << "        <NOT FOUND> " << keyword
+         << " has no such entries to delete.\n";
+  } else {
+    cout << "        <DELETED> " << deletedCount
+         << ((deletedCount == 1) ? " entry" : " entries") << " of "
+         << keyword << ".\n";
   }
   cout << "       |\n";
 }
 
+void InteractiveDictionary::printCompaction(bool isStarted) {
+  cout << "       |\n";
+  if (isStarted) {
+    cout << "        <COMPACTING> The edits are being written to "
+         << getDataFilePath() << ".\n";
+  } else if (isCompacting()) {
+    cout << "        <NOT COMPACTING> A compaction is running.\n";
+  } else {
+    cout << "        <NOT COMPACTING> There are no edits to compact.\n";
+  }
+  cout << "       |\n";
+}
+
+void InteractiveDictionary::printEditError() {
+  cout << "       |\n";
+  cout << "        EDIT HOW-TO,  please enter:\n";
+  cout << "        '!add' -then a key -then a part of speech -then a "
+          "definition\n";
+  cout << "        '!delete' -then a key -then an optional part of speech "
+          "-then\n";
+  cout << "        an optional definition, to delete the matching entries\n";
+  cout << "        '!compact' to write the edits into the data file\n";
+  cout << "        A key may not have wildcards, and neither may have '|'.\n";
+  cout << "       |\n";
+}
+
+void InteractiveDictionary::printLookupReport(size_t words, size_t found,
+                                              double seconds) {
+  cout << "! Looked up " << words << " words (" << found << " found) in "
+       << seconds << " s ("
+       << ((seconds > 0) ? words / seconds : 0) << " lookups/s)\n";
+}
+
+/**
+ * @brief Prints that a 'limit' or 'offset' parameter was disregarded
+ *        because no number followed it.
+ */
+void InteractiveDictionary::printPageError(AccountedString &parameter) {
+  cout << "       |\n";
+  cout << "        <The entered parameter '" << parameter
+       << "' is NOT followed by a number.>\n";
+  cout << "        <The entered parameter '" << parameter
+       << "' was disregarded.>\n";
+  cout << "       |\n";
+}
+
 void InteractiveDictionary::printIntroduction(int &keyWords, int &definitions) {
   cout << "====== DICTIONARY 340 C++ =====\n";
   cout << "------ Keywords: " << keyWords << "\n";
@@ -321,6 +816,11 @@ void InteractiveDictionary::printManual() {
   cout << "        PARAMETER HOW-TO,  please enter:\n";
   cout << "        1. A search key -then 2. An optional part of speech -then\n";
   cout << "        3. An optional 'distinct' -then 4. An optional 'reverse'\n";
+  cout << "        A key may have wildcards: '?' for any one character and\n";
+  cout << "        '*' for any characters, to list the matching keys.\n";
+  cout << "        Anywhere after the key: an optional 'limit N' and/or\n";
+  cout << "        an optional 'offset M' to print N entries after the Mth\n";
+  cout << "        Or '!add', '!delete' or '!compact' to edit entries\n";
   cout << "       |\n";
 }
 
@@ -335,6 +835,48 @@ void InteractiveDictionary::printNotFound() {
   cout << "       |\n";
 }
 
+/**
+ * @brief Prints the missing keywords that were searched for the most,
+ *        to help decide what goes into the next release.
+ */
+void InteractiveDictionary::printMisses() {
+  vector<MissSketch::Miss> misses = missedKeywords.topMisses();
+
+  cout << "       |\n";
+  cout << "        <MISSES> " << missedKeywords.totalMisses()
+       << " searches were NOT FOUND.\n";
+  for (MissSketch::Miss &miss : misses) {
+    cout << "        " << miss.keyword << " : ~" << miss.estimate << "\n";
+  }
+  cout << "       |\n";
+}
+
+/**
+ * @brief Prints the throughput and latency percentiles of a replay.
+ */
+void InteractiveDictionary::printReplayReport(LatencyHistogram &latencies,
+                                              double seconds,
+                                              double queriesPerSecond,
+                                              bool isRecordedPace) {
+  cout << "====== REPLAY REPORT =====\n";
+  if (isRecordedPace) {
+    cout << "------ Mode: open loop at the recorded pace\n";
+  } else if (queriesPerSecond > 0) {
+    cout << "------ Mode: open loop at " << queriesPerSecond
+         << " queries/s\n";
+  } else {
+    cout << "------ Mode: closed loop\n";
+  }
+  cout << "------ Queries: " << latencies.getCount() << " in " << seconds
+       << " s (" << ((seconds > 0) ? latencies.getCount() / seconds : 0)
+       << " queries/s)\n";
+  cout << "------ Latency (us): mean " << latencies.getMean() / 1000
+       << ", p50 " << latencies.percentile(50) / 1000.0 << ", p99 "
+       << latencies.percentile(99) / 1000.0 << ", p99.9 "
+       << latencies.percentile(99.9) / 1000.0 << ", max "
+       << latencies.getMax() / 1000.0 << "\n";
+}
+
 void InteractiveDictionary::printThankYou() {
   cout << "\n-----THANK YOU-----\n";
 }
@@ -16,65 +16,145 @@
 #define INTERACTIVEDICTIONARY_H
 
 #include "Dictionary.h"
+#include "LatencyHistogram.h"
+#include "MissSketch.h"
+#include "SessionLog.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <deque>
 #include <iostream>
 #include <iterator>
 #include <queue>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 class InteractiveDictionary : public Dictionary {
 public:
+  InteractiveDictionary();
+
   void read();
+  bool respond(AccountedString &searchQuery);
+  void lookupBatch(std::istream &words);
+  bool recordSession(const std::string &logPath);
+  void replay(const std::vector<RecordedQuery> &queries,
+              double queriesPerSecond, bool isRecordedPace);
 
 private:
-  const std::string OFFSET{""};
+  typedef std::vector<AccountedString, AccountingAllocator<AccountedString>>
+      QueryTokens;
+
+  /**
+   * @brief   The answer to a search: a view of a keyword's stored entries.
+   *          It holds pointers to the entries in the order they are shown,
+   *          leaving out filtered ones, and the page of them to print.
+   */
+  struct QueryResult {
+    EntryViews entries;
+    std::size_t offset;
+    std::size_t limit;
+    bool isFound;
+  };
+
+  static const std::size_t LOOKUP_BATCH_SIZE = 4096;
+  static const std::size_t MODIFIER_COUNT = 4;
+  static const std::size_t NO_LIMIT = static_cast<std::size_t>(-1);
 
   const std::string ERROR_PART_OF_SPEECH{"a part of speech"};
   const std::string ERROR_DISTINCT{"'distinct'"};
   const std::string ERROR_REVERSE{"'reverse'"};
 
-  const std::string PART_OF_SPEECH{"partOfSpeech"};
-  const std::string DISTINCT = {"distinct"};
-  const std::string REVERSE = {"reverse"};
-
-  void modifyEntries(std::vector<Entry> &, std::vector<std::string> &);
-
-  void sortInOrder(std::vector<Entry> &);
-  void sortInReverseOrder(std::vector<Entry> &);
-
-  void filterByDistinctDefinitions(std::vector<Entry> &);
-  void filterByDistinctEntries(std::vector<Entry> &);
-  void filterByPartOfSpeech(std::vector<Entry> &, std::string &);
+  const AccountedString PART_OF_SPEECH{"partOfSpeech"};
+  const AccountedString DISTINCT = {"distinct"};
+  const AccountedString REVERSE = {"reverse"};
+  const AccountedString LIMIT = {"limit"};
+  const AccountedString OFFSET = {"offset"};
+  const AccountedString ADD = {"!add"};
+  const AccountedString DELETE = {"!delete"};
+  const AccountedString COMPACT = {"!compact"};
+
+  /** The modifiers the 2nd, 3rd and 4th parameters can be, and the
+   *  errors printed when they are not. The 1st parameter is the key. */
+  const AccountedString *const MODIFIERS[MODIFIER_COUNT]{
+      nullptr, &PART_OF_SPEECH, &DISTINCT, &REVERSE};
+  const std::string *const ERROR_MODIFIER_MESSAGES[MODIFIER_COUNT]{
+      nullptr, &ERROR_PART_OF_SPEECH, &ERROR_DISTINCT, &ERROR_REVERSE};
+
+  MissSketch missedKeywords;
+  AccountedString outputBuffer;
+  SessionRecorder sessionRecorder;
+
+  /**
+   * @brief   A stream buffer that throws away what is printed during
+   *          a replay.
+   */
+  class NullBuffer : public std::streambuf {
+  protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override {
+      return n;
+    }
+  };
+
+  QueryResult makeQueryResult();
+  void viewEntries(QueryResult &, AccountedString &entryWord);
+  void edit(AccountedString &searchQuery, AccountedString &command);
+  void modifyEntries(QueryResult &, QueryTokens &);
+  void takePage(QueryResult &, QueryTokens &);
+
+  void sortInOrder(QueryResult &);
+  void sortInReverseOrder(QueryResult &);
+  static int compareInOrder(const Entry &, const Entry &);
+
+  void filterByDistinctDefinitions(QueryResult &);
+  void filterByDistinctEntries(QueryResult &);
+  void filterByPartOfSpeech(QueryResult &, AccountedString &);
 
   void printIntroduction(int &, int &);
   void printSearchNumber(int &);
   void printManual();
   void printThankYou();
   void printNotFound();
-  void printParameterErrors(std::deque<std::string> &modifiers,
-                            std::string &parameter, int &parameterNumber);
-  void printEntries(std::vector<Entry> &);
+  void printMisses();
+  void printParameterErrors(std::size_t firstModifier,
+                            AccountedString &parameter, int &parameterNumber);
+  void printEntries(QueryResult &);
+  void printPageError(AccountedString &parameter);
+  void printMatchingKeywords(QueryResult &, AccountedString &pattern);
+  void printLookups(QueryTokens &);
+  void printAdded(AccountedString &keyword, AccountedString &partOfSpeech,
+                  AccountedString &definition, bool isAdded);
+  void printDeleted(AccountedString &keyword, std::size_t deletedCount);
+  void printCompaction(bool isStarted);
+  void printEditError();
+  void printLookupReport(std::size_t words, std::size_t found,
+                         double seconds);
+  void printReplayReport(LatencyHistogram &latencies, double seconds,
+                         double queriesPerSecond, bool isRecordedPace);
 
   bool isValid(std::size_t searchQueryCount);
-  bool isValid(std::string &entryWord);
-  bool isHelp(std::string &);
-  bool isQuit(std::string &);
-  bool isAvailableModifier(std::deque<std::string> &modifiers,
-                           std::string &parameter, int &parameterNumber);
-  bool isPartOfSpeech(std::string &);
-  bool entriesHavePartOfSpeech(std::vector<Entry> &, std::string &);
-
-  std::vector<std::string> getTokens(std::string &content);
-  std::vector<std::string> parseSearchQuery(std::string &content);
+  bool isValid(AccountedString &entryWord);
+  bool isHelp(AccountedString &);
+  bool isQuit(AccountedString &);
+  bool isMissReport(AccountedString &);
+  bool isLookup(AccountedString &);
+  bool isEdit(AccountedString &);
+  bool isAvailableModifier(std::size_t firstModifier,
+                           AccountedString &parameter, int &parameterNumber);
+  bool isPartOfSpeech(AccountedString &);
+  bool entriesHavePartOfSpeech(QueryResult &, AccountedString &);
+  bool isNumber(AccountedString &);
+
+  QueryTokens getTokens(AccountedString &content);
+  QueryTokens parseSearchQuery(AccountedString &content);
   std::string getOrdinalNumber(int &);
 
-  std::map<std::string, std::string> partOfSpeechMap{
+  std::map<AccountedString, AccountedString> partOfSpeechMap{
       {"adjective", {PART_OF_SPEECH}},    {"adverb", {PART_OF_SPEECH}},
-      {"noun", {PART_OF_SPEECH}},         {"conjuction", {PART_OF_SPEECH}},
+      {"noun", {PART_OF_SPEECH}},         {"conjunction", {PART_OF_SPEECH}},
       {"interjection", {PART_OF_SPEECH}}, {"preposition", {PART_OF_SPEECH}},
       {"pronoun", {PART_OF_SPEECH}},      {"verb", {PART_OF_SPEECH}}};
 
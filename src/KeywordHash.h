@@ -0,0 +1,36 @@
+/**
+ * File:        KeywordHash.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains the hash function shared by the structures
+ *  that index keywords of a dictionary.
+ */
+
+#ifndef KEYWORDHASH_H
+#define KEYWORDHASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Returns a 64-bit FNV-1a hash of a keyword, finalized with a
+ *        mixing step so that its upper and lower halves can be used as
+ *        two independent hashes.
+ */
+inline std::uint64_t hashKeyword(const char *keyword, std::size_t length) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < length; i++) {
+    hash ^= static_cast<unsigned char>(keyword[i]);
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+#endif // KEYWORDHASH_H
@@ -0,0 +1,208 @@
+/**
+ * File:        KeywordHashIndex.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  that find what is stored under a keyword through a hash table,
+ *  one keyword at a time or many at once.
+ */
+
+#ifndef KEYWORDHASHINDEX_H
+#define KEYWORDHASHINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "KeywordHash.h"
+#include "MemoryAccounting.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief Asks the processor to start loading the cache line of an address
+ *        that will be read soon. Does nothing where there is no way to.
+ */
+inline void prefetchForRead(const void *address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+  (void)address;
+#endif
+}
+
+/**
+ * @brief   An open-addressing hash table from keywords to values that are
+ *          stored elsewhere, such as in a dictionary's map. Keywords and
+ *          values must stay where they are while they are indexed.
+ *
+ *          findBatch() finds many keywords at once in stages: it hashes a
+ *          group of keywords and prefetches their slots, then reads the
+ *          slots and prefetches the keywords they point to, then compares
+ *          the keywords. The cache misses of a whole group overlap,
+ *          instead of one keyword's misses following another's.
+ */
+template <typename Value> class KeywordHashIndex {
+public:
+  static const std::size_t BATCH_SIZE = 16;
+
+  explicit KeywordHashIndex(
+      MemoryResource *resource = MemoryResource::defaultResource())
+      : slots(AccountingAllocator<Slot>(resource)) {}
+
+  /**
+   * @brief Makes room for the given number of keywords, so that adding
+   *        them does not grow the table again.
+   */
+  void reserve(std::size_t keywordCount) {
+    std::size_t capacity = MIN_CAPACITY;
+    while (capacity < keywordCount * 2) {
+      capacity *= 2;
+    }
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  /**
+   * @brief Indexes a value under a keyword that is not indexed yet.
+   */
+  void add(const AccountedString &keyword, const Value *value) {
+    if ((count + 1) * 2 > slots.size()) {
+      rehash(slots.empty() ? MIN_CAPACITY : slots.size() * 2);
+    }
+    insert(Slot{hashKeyword(keyword.data(), keyword.size()), &keyword, value});
+    ++count;
+  }
+
+  void clear() {
+    slots.clear();
+    count = 0;
+  }
+
+  std::size_t size() const { return count; }
+
+  std::size_t sizeInBytes() const { return slots.capacity() * sizeof(Slot); }
+
+  /**
+   * @brief Returns the value indexed under a keyword, or nullptr if the
+   *        keyword is not indexed.
+   */
+  const Value *find(const AccountedString &keyword) const {
+    if (slots.empty()) {
+      return nullptr;
+    }
+    return probe(keyword, hashKeyword(keyword.data(), keyword.size()));
+  }
+
+  /**
+   * @brief Finds keywordCount keywords at once and puts the value indexed
+   *        under each one, or nullptr, at the same position of values.
+   */
+  void findBatch(const AccountedString *keywords, std::size_t keywordCount,
+                 const Value **values) const {
+    if (slots.empty()) {
+      for (std::size_t i = 0; i < keywordCount; i++) {
+        values[i] = nullptr;
+      }
+      return;
+    }
+
+    std::uint64_t hashes[BATCH_SIZE];
+    const Slot *candidates[BATCH_SIZE];
+    for (std::size_t first = 0; first < keywordCount; first += BATCH_SIZE) {
+      std::size_t groupSize = (keywordCount - first < BATCH_SIZE)
+                                  ? keywordCount - first
+                                  : BATCH_SIZE;
+      const AccountedString *group = keywords + first;
+
+      for (std::size_t i = 0; i < groupSize; i++) {
+        hashes[i] = hashKeyword(group[i].data(), group[i].size());
+        prefetchForRead(&slots[hashes[i] & mask]);
+      }
+
+      for (std::size_t i = 0; i < groupSize; i++) {
+        candidates[i] = firstSlotWithHash(hashes[i]);
+        if (candidates[i] != nullptr) {
+          prefetchForRead(candidates[i]->keyword);
+        }
+      }
+
+      for (std::size_t i = 0; i < groupSize; i++) {
+        if (candidates[i] == nullptr) {
+          values[first + i] = nullptr;
+        } else if (*candidates[i]->keyword == group[i]) {
+          values[first + i] = candidates[i]->value;
+        } else {
+          // Another keyword with the same hash: keep probing past it.
+          values[first + i] = probe(group[i], hashes[i]);
+        }
+      }
+    }
+  }
+
+private:
+  static const std::size_t MIN_CAPACITY = 16;
+
+  /** A keyword and its value. Empty slots have no keyword. */
+  struct Slot {
+    std::uint64_t hash;
+    const AccountedString *keyword;
+    const Value *value;
+  };
+
+  std::vector<Slot, AccountingAllocator<Slot>> slots;
+  std::size_t mask{0};
+  std::size_t count{0};
+
+  void rehash(std::size_t capacity) {
+    std::vector<Slot, AccountingAllocator<Slot>> oldSlots(
+        capacity, Slot{0, nullptr, nullptr}, slots.get_allocator());
+    oldSlots.swap(slots);
+    mask = capacity - 1;
+    for (const Slot &slot : oldSlots) {
+      if (slot.keyword != nullptr) {
+        insert(slot);
+      }
+    }
+  }
+
+  void insert(const Slot &slot) {
+    std::size_t i = slot.hash & mask;
+    while (slots[i].keyword != nullptr) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = slot;
+  }
+
+  const Slot *firstSlotWithHash(std::uint64_t hash) const {
+    for (std::size_t i = hash & mask; slots[i].keyword != nullptr;
+         i = (i + 1) & mask) {
+      if (slots[i].hash == hash) {
+        return &slots[i];
+      }
+    }
+    return nullptr;
+  }
+
+  const Value *probe(const AccountedString &keyword,
+                     std::uint64_t hash) const {
+    for (std::size_t i = hash & mask; slots[i].keyword != nullptr;
+         i = (i + 1) & mask) {
+      if (slots[i].hash == hash && *slots[i].keyword == keyword) {
+        return slots[i].value;
+      }
+    }
+    return nullptr;
+  }
+};
+
+#endif // KEYWORDHASHINDEX_H
@@ -0,0 +1,402 @@
+/**
+ * File:        KeywordPatternIndex.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  that find the keywords matching a wildcard pattern, such as
+ *  b??k* or *binder, without visiting every keyword.
+ */
+
+#include "KeywordPatternIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+using std::size_t;
+using std::uint32_t;
+
+const char KeywordPatternIndex::BEGIN;
+const char KeywordPatternIndex::END;
+
+/**
+ * @brief Constructs an empty index that takes its memory from the
+ *        given resource.
+ */
+KeywordPatternIndex::KeywordPatternIndex(MemoryResource *resource)
+    : resource(resource), keywords(Keywords::allocator_type(resource)),
+      byKeyword(KeywordIds::allocator_type(resource)),
+      byReversedKeyword(KeywordIds::allocator_type(resource)),
+      trigrams(0, Trigrams::hasher(), Trigrams::key_equal(),
+               Trigrams::allocator_type(resource)) {}
+
+/**
+ * @brief Adds a keyword. Adding keywords in sorted order, as a map
+ *        visits them, keeps every insertion at the end.
+ */
+void KeywordPatternIndex::add(const AccountedString &keyword) {
+  KeywordId id = keywords.size();
+  keywords.push_back(&keyword);
+
+  byKeyword.insert(std::upper_bound(byKeyword.begin(), byKeyword.end(), id,
+                                    [this](KeywordId id1, KeywordId id2) {
+                                      return isSortedBefore(*keywords[id1],
+                                                            *keywords[id2]);
+                                    }),
+                   id);
+  byReversedKeyword.insert(
+      std::upper_bound(byReversedKeyword.begin(), byReversedKeyword.end(), id,
+                       [this](KeywordId id1, KeywordId id2) {
+                         return compareReversed(*keywords[id1], *keywords[id2],
+                                                std::string::npos) < 0;
+                       }),
+      id);
+  addTrigramsOf(keyword, id);
+}
+
+/**
+ * @brief Adds many keywords, in any order. The new keywords are sorted
+ *        among themselves and merged into the sorted ones once, instead
+ *        of being inserted one by one.
+ */
+void KeywordPatternIndex::addAll(const Keywords &newKeywords) {
+  if (newKeywords.empty()) {
+    return;
+  }
+  size_t oldSize = byKeyword.size();
+  for (const AccountedString *keyword : newKeywords) {
+    KeywordId id = keywords.size();
+    keywords.push_back(keyword);
+    byKeyword.push_back(id);
+    byReversedKeyword.push_back(id);
+    addTrigramsOf(*keyword, id);
+  }
+
+  auto isBefore = [this](KeywordId id1, KeywordId id2) {
+    return isSortedBefore(*keywords[id1], *keywords[id2]);
+  };
+  std::sort(byKeyword.begin() + oldSize, byKeyword.end(), isBefore);
+  std::inplace_merge(byKeyword.begin(), byKeyword.begin() + oldSize,
+                     byKeyword.end(), isBefore);
+
+  auto isReversedBefore = [this](KeywordId id1, KeywordId id2) {
+    return compareReversed(*keywords[id1], *keywords[id2],
+                           std::string::npos) < 0;
+  };
+  std::sort(byReversedKeyword.begin() + oldSize, byReversedKeyword.end(),
+            isReversedBefore);
+  std::inplace_merge(byReversedKeyword.begin(),
+                     byReversedKeyword.begin() + oldSize,
+                     byReversedKeyword.end(), isReversedBefore);
+}
+
+void KeywordPatternIndex::clear() {
+  keywords.clear();
+  byKeyword.clear();
+  byReversedKeyword.clear();
+  trigrams.clear();
+}
+
+size_t KeywordPatternIndex::size() const { return keywords.size(); }
+
+/**
+ * @brief Puts the keywords matching a pattern into matches, in sorted
+ *        order. Scratch memory comes from the resource of matches.
+ */
+void KeywordPatternIndex::match(const AccountedString &pattern,
+                                Keywords &matches) const {
+  MemoryResource *scratch = matches.get_allocator().getResource();
+  Plan plan{Plan::ALL_KEYWORDS, 0, 0,
+            Postings(Postings::allocator_type(scratch)), 0};
+  makePlan(pattern, plan);
+
+  if (plan.source == Plan::ALL_KEYWORDS) {
+    for (KeywordId id : byKeyword) {
+      addCandidate(id, pattern, matches);
+    }
+    return;
+  }
+  if (plan.source == Plan::PREFIX) {
+    for (size_t i = plan.first; i < plan.last; i++) {
+      addCandidate(byKeyword[i], pattern, matches);
+    }
+    return;
+  }
+
+  if (plan.source == Plan::SUFFIX) {
+    for (size_t i = plan.first; i < plan.last; i++) {
+      addCandidate(byReversedKeyword[i], pattern, matches);
+    }
+  } else if (!plan.postings.empty()) {
+    // Keep the ids of the smallest posting list found in all others.
+    const KeywordIds &smallest = *plan.postings.front();
+    for (KeywordId id : smallest) {
+      bool isInAll = true;
+      for (size_t i = 1; i < plan.postings.size() && isInAll; i++) {
+        isInAll = std::binary_search(plan.postings[i]->begin(),
+                                     plan.postings[i]->end(), id);
+      }
+      if (isInAll) {
+        addCandidate(id, pattern, matches);
+      }
+    }
+  }
+  std::sort(matches.begin(), matches.end(),
+            [](const AccountedString *s1, const AccountedString *s2) {
+              return isSortedBefore(*s1, *s2);
+            });
+}
+
+/**
+ * @brief Returns how many keywords would be checked against a pattern.
+ */
+size_t
+KeywordPatternIndex::getCandidateCount(const AccountedString &pattern) const {
+  Plan plan{Plan::ALL_KEYWORDS, 0, 0, Postings(), 0};
+  makePlan(pattern, plan);
+  return plan.candidateCount;
+}
+
+/**
+ * @brief Returns true if a keyword has a wildcard, '?' or '*'.
+ */
+bool KeywordPatternIndex::isPattern(const AccountedString &keyword) {
+  return std::any_of(keyword.begin(), keyword.end(), isWildcard);
+}
+
+/**
+ * @brief Returns true if a keyword sorts before another in the index,
+ *        which ignores letter case.
+ */
+bool KeywordPatternIndex::isSortedBefore(const AccountedString &s1,
+                                         const AccountedString &s2) {
+  return compareFolded(s1, s2, std::string::npos) < 0;
+}
+
+/**
+ * @brief Returns true if a keyword matches a pattern, ignoring letter
+ *        case. After a mismatch, the last '*' is retried one character
+ *        further.
+ */
+bool KeywordPatternIndex::matchesPattern(const AccountedString &keyword,
+                                         const AccountedString &pattern) {
+  size_t k = 0;
+  size_t p = 0;
+  size_t star = std::string::npos;
+  size_t starKeywordIndex = 0;
+  while (k < keyword.size()) {
+    if (p < pattern.size() &&
+        (pattern[p] == '?' || foldCase(pattern[p]) == foldCase(keyword[k]))) {
+      ++k;
+      ++p;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      starKeywordIndex = k;
+    } else if (star != std::string::npos) {
+      p = star + 1;
+      k = ++starKeywordIndex;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+/** ---START:---- PLANNING HELPER METHODS ------------------------- */
+
+/**
+ * @brief Picks the source with the fewest candidates for a pattern. A
+ *        trigram of the pattern that no keyword has means nothing can
+ *        match.
+ */
+void KeywordPatternIndex::makePlan(const AccountedString &pattern,
+                                   Plan &plan) const {
+  plan.source = Plan::ALL_KEYWORDS;
+  plan.candidateCount = keywords.size();
+
+  size_t prefixLength =
+      std::find_if(pattern.begin(), pattern.end(), isWildcard) -
+      pattern.begin();
+  if (prefixLength > 0) {
+    KeywordIds::const_iterator first = std::lower_bound(
+        byKeyword.begin(), byKeyword.end(), pattern,
+        [this, prefixLength](KeywordId id, const AccountedString &prefix) {
+          return compareFolded(*keywords[id], prefix, prefixLength) < 0;
+        });
+    KeywordIds::const_iterator last = std::upper_bound(
+        first, byKeyword.end(), pattern,
+        [this, prefixLength](const AccountedString &prefix, KeywordId id) {
+          return compareFolded(*keywords[id], prefix, prefixLength) > 0;
+        });
+    if (static_cast<size_t>(last - first) < plan.candidateCount) {
+      plan.source = Plan::PREFIX;
+      plan.first = first - byKeyword.begin();
+      plan.last = last - byKeyword.begin();
+      plan.candidateCount = last - first;
+    }
+  }
+
+  size_t suffixLength =
+      std::find_if(pattern.rbegin(), pattern.rend(), isWildcard) -
+      pattern.rbegin();
+  if (suffixLength > 0) {
+    KeywordIds::const_iterator first = std::lower_bound(
+        byReversedKeyword.begin(), byReversedKeyword.end(), pattern,
+        [this, suffixLength](KeywordId id, const AccountedString &suffix) {
+          return compareReversed(*keywords[id], suffix, suffixLength) < 0;
+        });
+    KeywordIds::const_iterator last = std::upper_bound(
+        first, byReversedKeyword.end(), pattern,
+        [this, suffixLength](const AccountedString &suffix, KeywordId id) {
+          return compareReversed(*keywords[id], suffix, suffixLength) > 0;
+        });
+    if (static_cast<size_t>(last - first) < plan.candidateCount) {
+      plan.source = Plan::SUFFIX;
+      plan.first = first - byReversedKeyword.begin();
+      plan.last = last - byReversedKeyword.begin();
+      plan.candidateCount = last - first;
+    }
+  }
+
+  // Trigrams are read from the pattern between its anchors, skipping
+  // any that overlap a wildcard.
+  size_t anchoredLength = pattern.size() + 2;
+  auto anchoredAt = [&pattern, anchoredLength](size_t i) {
+    return (i == 0) ? BEGIN
+                    : (i == anchoredLength - 1) ? END : pattern[i - 1];
+  };
+  plan.postings.clear();
+  for (size_t i = 0; i + 2 < anchoredLength; i++) {
+    char c1 = anchoredAt(i);
+    char c2 = anchoredAt(i + 1);
+    char c3 = anchoredAt(i + 2);
+    if (isWildcard(c1) || isWildcard(c2) || isWildcard(c3)) {
+      continue;
+    }
+    Trigrams::const_iterator posting = trigrams.find(trigramOf(c1, c2, c3));
+    if (posting == trigrams.end()) {
+      plan.source = Plan::TRIGRAMS;
+      plan.postings.clear();
+      plan.candidateCount = 0;
+      return;
+    }
+    plan.postings.push_back(&posting->second);
+  }
+  if (plan.postings.empty()) {
+    return;
+  }
+  std::sort(plan.postings.begin(), plan.postings.end(),
+            [](const KeywordIds *ids1, const KeywordIds *ids2) {
+              return ids1->size() < ids2->size();
+            });
+  if (plan.postings.front()->size() < plan.candidateCount) {
+    plan.source = Plan::TRIGRAMS;
+    plan.candidateCount = plan.postings.front()->size();
+  }
+}
+
+/**
+ * @brief Adds a candidate to matches if it matches the whole pattern.
+ */
+void KeywordPatternIndex::addCandidate(KeywordId id,
+                                       const AccountedString &pattern,
+                                       Keywords &matches) const {
+  if (matchesPattern(*keywords[id], pattern)) {
+    matches.push_back(keywords[id]);
+  }
+}
+
+/**
+ * @brief Adds a keyword to the posting list of each of its trigrams,
+ *        reading it between its anchors.
+ */
+void KeywordPatternIndex::addTrigramsOf(const AccountedString &keyword,
+                                        KeywordId id) {
+  size_t anchoredLength = keyword.size() + 2;
+  auto anchoredAt = [&keyword, anchoredLength](size_t i) {
+    return (i == 0) ? BEGIN
+                    : (i == anchoredLength - 1) ? END : keyword[i - 1];
+  };
+  for (size_t i = 0; i + 2 < anchoredLength; i++) {
+    uint32_t trigram =
+        trigramOf(anchoredAt(i), anchoredAt(i + 1), anchoredAt(i + 2));
+    Trigrams::iterator posting = trigrams.find(trigram);
+    if (posting == trigrams.end()) {
+      posting = trigrams
+                    .emplace(trigram,
+                             KeywordIds(KeywordIds::allocator_type(resource)))
+                    .first;
+    }
+    if (posting->second.empty() || posting->second.back() != id) {
+      posting->second.push_back(id);
+    }
+  }
+}
+
+/**
+ * @brief Returns the trigram of three characters, ignoring letter case.
+ */
+uint32_t KeywordPatternIndex::trigramOf(char c1, char c2, char c3) {
+  return (uint32_t{static_cast<unsigned char>(foldCase(c1))} << 16) |
+         (uint32_t{static_cast<unsigned char>(foldCase(c2))} << 8) |
+         static_cast<unsigned char>(foldCase(c3));
+}
+
+bool KeywordPatternIndex::isWildcard(char c) { return c == '?' || c == '*'; }
+
+char KeywordPatternIndex::foldCase(char c) {
+  return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+/**
+ * @brief Compares up to length characters of two strings, ignoring
+ *        letter case. A string that runs out first sorts first.
+ */
+int KeywordPatternIndex::compareFolded(const AccountedString &s1,
+                                       const AccountedString &s2,
+                                       size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    bool hasEnded1 = i >= s1.size();
+    bool hasEnded2 = i >= s2.size();
+    if (hasEnded1 || hasEnded2) {
+      return (hasEnded1 && hasEnded2) ? 0 : hasEnded1 ? -1 : 1;
+    }
+    unsigned char c1 = foldCase(s1[i]);
+    unsigned char c2 = foldCase(s2[i]);
+    if (c1 != c2) {
+      return (c1 < c2) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Compares up to length characters of two strings, read from
+ *        their ends and ignoring letter case. A string that runs out
+ *        first sorts first.
+ */
+int KeywordPatternIndex::compareReversed(const AccountedString &s1,
+                                         const AccountedString &s2,
+                                         size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    bool hasEnded1 = i >= s1.size();
+    bool hasEnded2 = i >= s2.size();
+    if (hasEnded1 || hasEnded2) {
+      return (hasEnded1 && hasEnded2) ? 0 : hasEnded1 ? -1 : 1;
+    }
+    unsigned char c1 = foldCase(s1[s1.size() - 1 - i]);
+    unsigned char c2 = foldCase(s2[s2.size() - 1 - i]);
+    if (c1 != c2) {
+      return (c1 < c2) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+/** ---END:------ PLANNING HELPER METHODS ------------------------- */
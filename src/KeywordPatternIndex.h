@@ -0,0 +1,109 @@
+/**
+ * File:        KeywordPatternIndex.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  that find the keywords matching a wildcard pattern, such as
+ *  b??k* or *binder, without visiting every keyword.
+ */
+
+#ifndef KEYWORDPATTERNINDEX_H
+#define KEYWORDPATTERNINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "MemoryAccounting.h"
+
+/**
+ * @brief   An index of keywords for wildcard patterns, where '?' matches
+ *          any one character and '*' matches any characters. Candidates
+ *          come from whichever is smallest of:
+ *            - the keywords starting with the pattern's literal prefix,
+ *            - the keywords ending with its literal suffix, found in
+ *              keywords sorted by their reversed spelling,
+ *            - the keywords having every trigram (three characters in a
+ *              row) of the pattern's literal parts,
+ *          and are then checked against the whole pattern. Letter case
+ *          is ignored throughout, so 'book' matches Book. Keywords are
+ *          not copied; the index points at the caller's strings, which
+ *          must outlive it.
+ */
+class KeywordPatternIndex {
+public:
+  typedef std::vector<const AccountedString *,
+                      AccountingAllocator<const AccountedString *>>
+      Keywords;
+
+  explicit KeywordPatternIndex(
+      MemoryResource *resource = MemoryResource::defaultResource());
+
+  void add(const AccountedString &keyword);
+  void addAll(const Keywords &newKeywords);
+  void clear();
+
+  void match(const AccountedString &pattern, Keywords &matches) const;
+  std::size_t getCandidateCount(const AccountedString &pattern) const;
+  std::size_t size() const;
+
+  static bool isPattern(const AccountedString &keyword);
+  static bool isSortedBefore(const AccountedString &s1,
+                             const AccountedString &s2);
+  static bool matchesPattern(const AccountedString &keyword,
+                             const AccountedString &pattern);
+
+private:
+  typedef std::uint32_t KeywordId;
+  typedef std::vector<KeywordId, AccountingAllocator<KeywordId>> KeywordIds;
+  typedef std::unordered_map<
+      std::uint32_t, KeywordIds, std::hash<std::uint32_t>,
+      std::equal_to<std::uint32_t>,
+      AccountingAllocator<std::pair<const std::uint32_t, KeywordIds>>>
+      Trigrams;
+
+  typedef std::vector<const KeywordIds *,
+                      AccountingAllocator<const KeywordIds *>>
+      Postings;
+
+  static const char BEGIN = '\x02';
+  static const char END = '\x03';
+
+  /**
+   * @brief   The cheapest way found to get a pattern's candidates.
+   */
+  struct Plan {
+    enum Source { ALL_KEYWORDS, PREFIX, SUFFIX, TRIGRAMS } source;
+    std::size_t first;
+    std::size_t last;
+    Postings postings;
+    std::size_t candidateCount;
+  };
+
+  MemoryResource *resource;
+  Keywords keywords;
+  KeywordIds byKeyword;
+  KeywordIds byReversedKeyword;
+  Trigrams trigrams;
+
+  void makePlan(const AccountedString &pattern, Plan &plan) const;
+  void addTrigramsOf(const AccountedString &keyword, KeywordId id);
+  void addCandidate(KeywordId id, const AccountedString &pattern,
+                    Keywords &matches) const;
+
+  static std::uint32_t trigramOf(char c1, char c2, char c3);
+  static bool isWildcard(char c);
+  static char foldCase(char c);
+  static int compareFolded(const AccountedString &s1,
+                           const AccountedString &s2, std::size_t length);
+  static int compareReversed(const AccountedString &s1,
+                             const AccountedString &s2, std::size_t length);
+};
+
+#endif // KEYWORDPATTERNINDEX_H
@@ -0,0 +1,97 @@
+/**
+ * File:        LatencyHistogram.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  of a histogram that records latencies and reports their percentiles.
+ */
+
+#include "LatencyHistogram.h"
+
+using std::size_t;
+using std::uint64_t;
+
+/**
+ * @brief Constructs an empty histogram with buckets for every 64-bit value.
+ */
+LatencyHistogram::LatencyHistogram()
+    : counts(SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * HALF_SUB_BUCKETS, 0) {}
+
+void LatencyHistogram::record(uint64_t value) {
+  ++counts[indexOf(value)];
+  ++count;
+  total += value;
+  if (value > max) {
+    max = value;
+  }
+}
+
+/**
+ * @brief Returns the value that the given percent of recorded values
+ *        are at or below, for example percentile(99.9).
+ */
+uint64_t LatencyHistogram::percentile(double percent) const {
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t target = static_cast<uint64_t>(percent / 100 * count + 0.5);
+  target = (target == 0) ? 1 : (target > count) ? count : target;
+
+  uint64_t seen = 0;
+  for (size_t index = 0; index < counts.size(); index++) {
+    seen += counts[index];
+    if (seen >= target) {
+      uint64_t value = highestValueOf(index);
+      return (value < max) ? value : max;
+    }
+  }
+  return max;
+}
+
+uint64_t LatencyHistogram::getCount() const { return count; }
+
+uint64_t LatencyHistogram::getMax() const { return max; }
+
+double LatencyHistogram::getMean() const {
+  return (count == 0) ? 0 : total / count;
+}
+
+/** ---START:---- BUCKET HELPER METHODS ------------------------- */
+
+/**
+ * @brief Returns the bucket of a value. A value of 2^n or more, n >= 8,
+ *        keeps its 8 highest bits, of which the lower 7 pick one of the
+ *        128 buckets of its power of two.
+ */
+size_t LatencyHistogram::indexOf(uint64_t value) {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  int highestBit = 63;
+  while (!(value >> highestBit)) {
+    --highestBit;
+  }
+  int shift = highestBit - SUB_BUCKET_BITS + 1;
+  return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS +
+         ((value >> shift) - HALF_SUB_BUCKETS);
+}
+
+/**
+ * @brief Returns the largest value that falls into a bucket.
+ */
+uint64_t LatencyHistogram::highestValueOf(size_t index) {
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  uint64_t bucket = index - SUB_BUCKETS;
+  int shift = bucket / HALF_SUB_BUCKETS + 1;
+  uint64_t lowestValue = (bucket % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS)
+                         << shift;
+  return lowestValue + (uint64_t{1} << shift) - 1;
+}
+
+/** ---END:------ BUCKET HELPER METHODS ------------------------- */
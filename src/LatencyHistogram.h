@@ -0,0 +1,51 @@
+/**
+ * File:        LatencyHistogram.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  of a histogram that records latencies and reports their percentiles.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief   A histogram in the style of HdrHistogram: values below 256 get
+ *          a bucket each, and every larger power of two is split into 128
+ *          equal buckets, so any value is reported within 1% of itself
+ *          while the whole range of 64-bit values fits in 58 KB.
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  void record(std::uint64_t value);
+
+  std::uint64_t percentile(double percent) const;
+  std::uint64_t getCount() const;
+  std::uint64_t getMax() const;
+  double getMean() const;
+
+private:
+  static const int SUB_BUCKET_BITS = 8;
+  static const std::uint64_t SUB_BUCKETS = std::uint64_t{1} << SUB_BUCKET_BITS;
+  static const std::uint64_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+
+  std::vector<std::uint64_t> counts;
+  std::uint64_t count{0};
+  std::uint64_t max{0};
+  double total{0};
+
+  static std::size_t indexOf(std::uint64_t value);
+  static std::uint64_t highestValueOf(std::size_t index);
+};
+
+#endif // LATENCYHISTOGRAM_H
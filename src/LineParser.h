@@ -0,0 +1,256 @@
+/**
+ * File:        LineParser.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains a parser for lines of a data file, such as
+ *      book|noun -=>> A set of pages.|verb -=>> To reserve.
+ *  whose delimiters and grammar are fixed at compile time.
+ */
+
+#ifndef LINEPARSER_H
+#define LINEPARSER_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+
+/**
+ * @brief   The delimiters of the default data file format: a part of speech
+ *          follows '|', and a definition follows the token "-=>>".
+ *          Other formats are supported by a struct with the same members.
+ */
+struct DefaultLineGrammar {
+  static constexpr char prePartOfSpeechDelimiter() { return '|'; }
+  static constexpr const char *preDefinitionDelimiter() { return "-=>>"; }
+};
+
+/** ---START:---- COMPILE-TIME TABLE HELPERS ------------------------- */
+
+template <std::size_t... Bytes> struct ByteIndices {};
+
+template <std::size_t N, std::size_t... Bytes>
+struct MakeByteIndices : MakeByteIndices<N - 1, N - 1, Bytes...> {};
+
+template <std::size_t... Bytes> struct MakeByteIndices<0, Bytes...> {
+  typedef ByteIndices<Bytes...> type;
+};
+
+constexpr std::size_t lengthOf(const char *s) {
+  return (*s == '\0') ? 0 : 1 + lengthOf(s + 1);
+}
+
+/**
+ * @brief   What a byte means to the scanner of a grammar.
+ */
+enum LineByteClass : unsigned char {
+  TEXT_BYTE,
+  SPACE_BYTE,
+  PART_OF_SPEECH_DELIMITER_BYTE
+};
+
+template <typename Grammar, typename Indices> struct LineByteClassTable;
+
+/**
+ * @brief   The class of all 256 byte values, computed at compile time.
+ *          White space is what std::istream's operator>> splits on.
+ */
+template <typename Grammar, std::size_t... Bytes>
+struct LineByteClassTable<Grammar, ByteIndices<Bytes...>> {
+  static constexpr unsigned char classify(std::size_t byte) {
+    return (byte == static_cast<unsigned char>(
+                        Grammar::prePartOfSpeechDelimiter()))
+               ? PART_OF_SPEECH_DELIMITER_BYTE
+           : (byte == ' ' || byte == '\t' || byte == '\n' || byte == '\v' ||
+              byte == '\f' || byte == '\r')
+               ? SPACE_BYTE
+               : TEXT_BYTE;
+  }
+
+  static constexpr unsigned char classes[256] = {classify(Bytes)...};
+};
+
+template <typename Grammar, std::size_t... Bytes>
+constexpr unsigned char
+    LineByteClassTable<Grammar, ByteIndices<Bytes...>>::classes[256];
+
+/** ---END:------ COMPILE-TIME TABLE HELPERS ------------------------- */
+
+/**
+ * @brief   A table-driven parser of data file lines. Bytes are classified
+ *          by a 256-entry table, and every white-space separated token
+ *          moves a two-state machine through a constant transition table:
+ *
+ *          state \ token        text     has '|'      is "-=>>"
+ *          PART OF SPEECH       append   open sense   append
+ *          DEFINITION           append   append       -> PART OF SPEECH
+ *
+ *          Opening a sense moves to DEFINITION, and closes the sense
+ *          before it. Senses are handed to a sink, which must have:
+ *              void word(const char *word, std::size_t length);
+ *              void sense(const String &partOfSpeech,
+ *                         const String &definition,
+ *                         bool closedByNextSense);
+ *          where String is a string using the parser's allocator.
+ */
+template <typename Grammar, typename Allocator = std::allocator<char>>
+class LineParser {
+public:
+  typedef std::basic_string<char, std::char_traits<char>, Allocator> String;
+
+  explicit LineParser(const Allocator &allocator = Allocator())
+      : partOfSpeech(allocator), definition(allocator) {}
+
+  template <typename Sink> void parse(const String &line, Sink &sink);
+
+private:
+  enum State : unsigned char { AWAIT_PART_OF_SPEECH, AWAIT_DEFINITION };
+  enum TokenClass : unsigned char {
+    TEXT_TOKEN,
+    PART_OF_SPEECH_TOKEN,
+    DEFINITION_DELIMITER_TOKEN
+  };
+  enum Action : unsigned char { APPEND, OPEN_SENSE, SKIP };
+
+  struct Transition {
+    Action action;
+    State next;
+  };
+
+  typedef LineByteClassTable<Grammar, typename MakeByteIndices<256>::type>
+      ByteClasses;
+
+  static constexpr std::size_t DEFINITION_DELIMITER_LENGTH =
+      lengthOf(Grammar::preDefinitionDelimiter());
+
+  static constexpr Transition TRANSITIONS[2][3] = {
+      {{APPEND, AWAIT_PART_OF_SPEECH},
+       {OPEN_SENSE, AWAIT_DEFINITION},
+       {APPEND, AWAIT_PART_OF_SPEECH}},
+      {{APPEND, AWAIT_DEFINITION},
+       {APPEND, AWAIT_DEFINITION},
+       {SKIP, AWAIT_PART_OF_SPEECH}}};
+
+  String partOfSpeech;
+  String definition;
+
+  void append(const char *text, std::size_t length);
+  static bool isDefinitionDelimiter(const char *token, std::size_t length);
+};
+
+template <typename Grammar, typename Allocator>
+constexpr typename LineParser<Grammar, Allocator>::Transition
+    LineParser<Grammar, Allocator>::TRANSITIONS[2][3];
+
+/**
+ * @brief Parses one line, handing its word and every sense to the sink.
+ *        The last sense of a line is always handed over, even when the
+ *        line has no part of speech.
+ */
+template <typename Grammar, typename Allocator>
+template <typename Sink>
+void LineParser<Grammar, Allocator>::parse(const String &line, Sink &sink) {
+  const char *bytes = line.data();
+  const std::size_t size = line.size();
+  const unsigned char *classes = ByteClasses::classes;
+
+  // The word is everything before the first part of speech delimiter.
+  const void *firstDelimiter =
+      std::memchr(bytes, Grammar::prePartOfSpeechDelimiter(), size);
+  std::size_t wordEnd =
+      (firstDelimiter == nullptr)
+          ? size
+          : static_cast<const char *>(firstDelimiter) - bytes;
+  std::size_t wordStart = 0;
+  while (wordStart < wordEnd &&
+         classes[static_cast<unsigned char>(bytes[wordStart])] == SPACE_BYTE) {
+    ++wordStart;
+  }
+  while (wordEnd > wordStart &&
+         classes[static_cast<unsigned char>(bytes[wordEnd - 1])] ==
+             SPACE_BYTE) {
+    --wordEnd;
+  }
+  sink.word(bytes + wordStart, wordEnd - wordStart);
+
+  partOfSpeech.clear();
+  definition.clear();
+  State state = AWAIT_PART_OF_SPEECH;
+  bool hasPartOfSpeech = false;
+
+  std::size_t i = 0;
+  while (i < size) {
+    while (i < size &&
+           classes[static_cast<unsigned char>(bytes[i])] == SPACE_BYTE) {
+      ++i;
+    }
+    if (i == size) {
+      break;
+    }
+
+    const std::size_t tokenStart = i;
+    std::size_t delimiterIndex = size;
+    unsigned char byteClass;
+    while (i < size && (byteClass = classes[static_cast<unsigned char>(
+                            bytes[i])]) != SPACE_BYTE) {
+      if (byteClass == PART_OF_SPEECH_DELIMITER_BYTE &&
+          delimiterIndex == size) {
+        delimiterIndex = i;
+      }
+      ++i;
+    }
+    const char *token = bytes + tokenStart;
+    const std::size_t tokenLength = i - tokenStart;
+
+    TokenClass tokenClass =
+        (delimiterIndex != size) ? PART_OF_SPEECH_TOKEN
+        : isDefinitionDelimiter(token, tokenLength)
+            ? DEFINITION_DELIMITER_TOKEN
+            : TEXT_TOKEN;
+    const Transition &transition = TRANSITIONS[state][tokenClass];
+    state = transition.next;
+
+    if (transition.action == APPEND) {
+      append(token, tokenLength);
+    } else if (transition.action == OPEN_SENSE) {
+      if (hasPartOfSpeech) {
+        append(token, delimiterIndex - tokenStart);
+        sink.sense(partOfSpeech, definition, true);
+        definition.clear();
+      }
+      partOfSpeech.assign(bytes + delimiterIndex + 1, i - delimiterIndex - 1);
+      hasPartOfSpeech = true;
+    }
+  }
+
+  sink.sense(partOfSpeech, definition, false);
+}
+
+/**
+ * @brief Adds a token to the definition being read, separated from the
+ *        previous token by one space.
+ */
+template <typename Grammar, typename Allocator>
+void LineParser<Grammar, Allocator>::append(const char *text,
+                                            std::size_t length) {
+  if (length == 0) {
+    return;
+  }
+  if (!definition.empty()) {
+    definition += ' ';
+  }
+  definition.append(text, length);
+}
+
+template <typename Grammar, typename Allocator>
+bool LineParser<Grammar, Allocator>::isDefinitionDelimiter(const char *token,
+                                                std::size_t length) {
+  return length == DEFINITION_DELIMITER_LENGTH &&
+         std::memcmp(token, Grammar::preDefinitionDelimiter(), length) == 0;
+}
+
+#endif // LINEPARSER_H
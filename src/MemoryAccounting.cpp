@@ -0,0 +1,174 @@
+/**
+ * File:        MemoryAccounting.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  of memory resources that count the memory they hand out.
+ */
+
+#include "MemoryAccounting.h"
+
+#include <new>
+
+using std::memory_order_relaxed;
+using std::ostream;
+using std::size_t;
+using std::string;
+
+/** ---START:---- MEMORY RESOURCE ------------------------- */
+
+MemoryResource::~MemoryResource() {}
+
+void *MemoryResource::allocate(size_t bytes, size_t alignment) {
+  return doAllocate(bytes, alignment);
+}
+
+void MemoryResource::deallocate(void *memory, size_t bytes, size_t alignment) {
+  doDeallocate(memory, bytes, alignment);
+}
+
+/**
+ * @brief   The resource of containers that were not given one: it
+ *          takes memory from the global heap without counting it.
+ */
+class NewDeleteResource : public MemoryResource {
+protected:
+  void *doAllocate(size_t bytes, size_t) override {
+    return ::operator new(bytes);
+  }
+  void doDeallocate(void *memory, size_t, size_t) override {
+    ::operator delete(memory);
+  }
+};
+
+MemoryResource *MemoryResource::defaultResource() {
+  static NewDeleteResource resource;
+  return &resource;
+}
+
+/** ---END:------ MEMORY RESOURCE ------------------------- */
+
+/** ---START:---- TRACKING RESOURCE ------------------------- */
+
+TrackingResource::TrackingResource(const string &subsystem)
+    : subsystem(subsystem), liveBytes(0), peakBytes(0), allocations(0) {}
+
+const string &TrackingResource::getSubsystem() const { return subsystem; }
+
+size_t TrackingResource::getLiveBytes() const {
+  return liveBytes.load(memory_order_relaxed);
+}
+
+size_t TrackingResource::getPeakBytes() const {
+  return peakBytes.load(memory_order_relaxed);
+}
+
+size_t TrackingResource::getAllocations() const {
+  return allocations.load(memory_order_relaxed);
+}
+
+void TrackingResource::printReport(ostream &out) const {
+  out << "------ " << subsystem << ": " << getLiveBytes() << " bytes live, "
+      << getPeakBytes() << " bytes at peak, " << getAllocations()
+      << " allocations\n";
+}
+
+void *TrackingResource::doAllocate(size_t bytes, size_t) {
+  void *memory = ::operator new(bytes);
+  allocations.fetch_add(1, memory_order_relaxed);
+  size_t live = liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+  size_t peak = peakBytes.load(memory_order_relaxed);
+  while (live > peak &&
+         !peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+  }
+  return memory;
+}
+
+void TrackingResource::doDeallocate(void *memory, size_t bytes, size_t) {
+  liveBytes.fetch_sub(bytes, memory_order_relaxed);
+  ::operator delete(memory);
+}
+
+/** ---END:------ TRACKING RESOURCE ------------------------- */
+
+/** ---START:---- ARENA RESOURCE ------------------------- */
+
+ArenaResource::ArenaResource(size_t initialBytes, MemoryResource *upstream)
+    : upstream(upstream) {
+  addChunk(initialBytes);
+}
+
+ArenaResource::~ArenaResource() { releaseChunks(); }
+
+/**
+ * @brief Frees everything handed out since the last reset. If more than
+ *        one chunk was needed, they are replaced by one chunk as large
+ *        as all of them.
+ */
+void ArenaResource::reset() {
+  used = 0;
+  if (chunks.size() > 1) {
+    size_t totalBytes = capacity;
+    releaseChunks();
+    addChunk(totalBytes);
+  }
+}
+
+size_t ArenaResource::getCapacity() const { return capacity; }
+
+size_t ArenaResource::getUpstreamAllocations() const {
+  return upstreamAllocations;
+}
+
+void ArenaResource::printReport(ostream &out) const {
+  out << "------ query arena: " << capacity << " bytes reserved, "
+      << upstreamAllocations << " upstream allocations\n";
+}
+
+/**
+ * @brief Hands out memory from the newest chunk, adding a chunk at least
+ *        twice as large when it does not fit.
+ */
+void *ArenaResource::doAllocate(size_t bytes, size_t alignment) {
+  Chunk &chunk = chunks.back();
+  size_t chunkUsed = used - (capacity - chunk.bytes);
+  size_t start = (chunkUsed + alignment - 1) / alignment * alignment;
+  if (start + bytes > chunk.bytes) {
+    size_t chunkBytes = chunk.bytes * 2;
+    addChunk((chunkBytes < bytes + alignment) ? bytes + alignment
+                                              : chunkBytes);
+    return doAllocate(bytes, alignment);
+  }
+  used += (start - chunkUsed) + bytes;
+  return chunk.memory + start;
+}
+
+void ArenaResource::doDeallocate(void *, size_t, size_t) {}
+
+/**
+ * @brief Takes a new chunk from upstream. The unused end of the
+ *        previous chunk is counted as used.
+ */
+void ArenaResource::addChunk(size_t bytes) {
+  chunks.push_back(Chunk{
+      static_cast<char *>(upstream->allocate(bytes, alignof(std::max_align_t))),
+      bytes});
+  used = capacity;
+  capacity += bytes;
+  ++upstreamAllocations;
+}
+
+void ArenaResource::releaseChunks() {
+  for (Chunk &chunk : chunks) {
+    upstream->deallocate(chunk.memory, chunk.bytes, alignof(std::max_align_t));
+  }
+  chunks.clear();
+  capacity = 0;
+  used = 0;
+}
+
+/** ---END:------ ARENA RESOURCE ------------------------- */
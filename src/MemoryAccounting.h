@@ -0,0 +1,157 @@
+/**
+ * File:        MemoryAccounting.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  of memory resources that count the memory they hand out, and of
+ *  an allocator that lets standard containers use them.
+ */
+
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Where memory comes from, in the spirit of C++17's
+ *          std::pmr::memory_resource.
+ */
+class MemoryResource {
+public:
+  virtual ~MemoryResource();
+
+  void *allocate(std::size_t bytes, std::size_t alignment);
+  void deallocate(void *memory, std::size_t bytes, std::size_t alignment);
+
+  static MemoryResource *defaultResource();
+
+protected:
+  virtual void *doAllocate(std::size_t bytes, std::size_t alignment) = 0;
+  virtual void doDeallocate(void *memory, std::size_t bytes,
+                            std::size_t alignment) = 0;
+};
+
+/**
+ * @brief   A resource that takes memory from the global heap and counts
+ *          the live bytes, peak bytes and allocations of one subsystem.
+ */
+class TrackingResource : public MemoryResource {
+public:
+  explicit TrackingResource(const std::string &subsystem);
+
+  const std::string &getSubsystem() const;
+  std::size_t getLiveBytes() const;
+  std::size_t getPeakBytes() const;
+  std::size_t getAllocations() const;
+
+  void printReport(std::ostream &out) const;
+
+protected:
+  void *doAllocate(std::size_t bytes, std::size_t alignment) override;
+  void doDeallocate(void *memory, std::size_t bytes,
+                    std::size_t alignment) override;
+
+private:
+  std::string subsystem;
+  std::atomic<std::size_t> liveBytes;
+  std::atomic<std::size_t> peakBytes;
+  std::atomic<std::size_t> allocations;
+};
+
+/**
+ * @brief   A resource for scratch memory that is thrown away all at once.
+ *          It hands out memory by bumping a pointer through its buffer and
+ *          frees nothing until reset. When the buffer runs out, it takes
+ *          more from its upstream resource, and the next reset merges
+ *          everything into one buffer, so it stops asking upstream once it
+ *          is as large as the largest use.
+ */
+class ArenaResource : public MemoryResource {
+public:
+  ArenaResource(std::size_t initialBytes, MemoryResource *upstream);
+  ~ArenaResource() override;
+
+  ArenaResource(const ArenaResource &) = delete;
+  ArenaResource &operator=(const ArenaResource &) = delete;
+
+  void reset();
+
+  std::size_t getCapacity() const;
+  std::size_t getUpstreamAllocations() const;
+
+  void printReport(std::ostream &out) const;
+
+protected:
+  void *doAllocate(std::size_t bytes, std::size_t alignment) override;
+  void doDeallocate(void *memory, std::size_t bytes,
+                    std::size_t alignment) override;
+
+private:
+  struct Chunk {
+    char *memory;
+    std::size_t bytes;
+  };
+
+  MemoryResource *upstream;
+  std::vector<Chunk> chunks;
+  std::size_t capacity{0};
+  std::size_t used{0};
+  std::size_t upstreamAllocations{0};
+
+  void addChunk(std::size_t bytes);
+  void releaseChunks();
+};
+
+/**
+ * @brief   An allocator that takes memory from a MemoryResource, so that
+ *          containers can be accounted to a subsystem or put in an arena.
+ */
+template <typename T> class AccountingAllocator {
+public:
+  typedef T value_type;
+
+  AccountingAllocator() : resource(MemoryResource::defaultResource()) {}
+  AccountingAllocator(MemoryResource *resource) : resource(resource) {}
+  template <typename U>
+  AccountingAllocator(const AccountingAllocator<U> &other)
+      : resource(other.getResource()) {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(resource->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *memory, std::size_t n) {
+    resource->deallocate(memory, n * sizeof(T), alignof(T));
+  }
+
+  MemoryResource *getResource() const { return resource; }
+
+private:
+  MemoryResource *resource;
+};
+
+template <typename T, typename U>
+bool operator==(const AccountingAllocator<T> &a1,
+                const AccountingAllocator<U> &a2) {
+  return a1.getResource() == a2.getResource();
+}
+
+template <typename T, typename U>
+bool operator!=(const AccountingAllocator<T> &a1,
+                const AccountingAllocator<U> &a2) {
+  return !(a1 == a2);
+}
+
+typedef std::basic_string<char, std::char_traits<char>,
+                          AccountingAllocator<char>>
+    AccountedString;
+
+#endif // MEMORYACCOUNTING_H
@@ -0,0 +1,140 @@
+/**
+ * File:        MissSketch.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  that count how often keywords that are NOT in a dictionary
+ *  were searched for, using a fixed amount of memory.
+ */
+
+#include "MissSketch.h"
+#include "KeywordHash.h"
+
+#include <algorithm>
+
+using std::lock_guard;
+using std::memory_order_relaxed;
+using std::mutex;
+using std::size_t;
+using std::sort;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+/**
+ * @brief Constructs a sketch in which nothing was missed yet.
+ */
+MissSketch::MissSketch() : misses(0), admissionEstimate(1) {
+  for (int row = 0; row < DEPTH; row++) {
+    for (int column = 0; column < WIDTH; column++) {
+      counters[row][column].store(0, memory_order_relaxed);
+    }
+  }
+  heavyHitters.reserve(TOP_K);
+}
+
+/**
+ * @brief Counts one more search for a missing keyword.
+ */
+void MissSketch::record(const char *keyword, size_t length) {
+  uint64_t hash = hashKeyword(keyword, length);
+  uint32_t estimate = UINT32_MAX;
+  for (int row = 0; row < DEPTH; row++) {
+    uint32_t count = counters[row][columnOf(hash, row)].fetch_add(
+                         1, memory_order_relaxed) +
+                     1;
+    estimate = std::min(estimate, count);
+  }
+  misses.fetch_add(1, memory_order_relaxed);
+
+  if (estimate >= admissionEstimate.load(memory_order_relaxed)) {
+    admit(keyword, length, estimate);
+  }
+}
+
+/**
+ * @brief Returns how many times a keyword was missed. It may be an
+ *        overestimate, but never an underestimate.
+ */
+uint32_t MissSketch::estimate(const char *keyword, size_t length) const {
+  uint64_t hash = hashKeyword(keyword, length);
+  uint32_t estimate = UINT32_MAX;
+  for (int row = 0; row < DEPTH; row++) {
+    uint32_t count =
+        counters[row][columnOf(hash, row)].load(memory_order_relaxed);
+    estimate = std::min(estimate, count);
+  }
+  return estimate;
+}
+
+uint64_t MissSketch::totalMisses() const {
+  return misses.load(memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the most missed keywords, most missed first.
+ */
+vector<MissSketch::Miss> MissSketch::topMisses() const {
+  vector<Miss> top;
+  {
+    lock_guard<mutex> lock(heavyHittersMutex);
+    top = heavyHitters;
+  }
+  sort(top.begin(), top.end(), [](const Miss &m1, const Miss &m2) {
+    return (m1.estimate != m2.estimate) ? m1.estimate > m2.estimate
+                                        : m1.keyword < m2.keyword;
+  });
+  return top;
+}
+
+/** ---START:---- HEAVY HITTER HELPER METHODS ------------------------- */
+
+/**
+ * @brief Puts a keyword into the heavy hitters, pushing out the least
+ *        missed one when they are full, then raises the estimate a
+ *        keyword needs to be considered next time.
+ */
+void MissSketch::admit(const char *keyword, size_t length, uint32_t estimate) {
+  lock_guard<mutex> lock(heavyHittersMutex);
+
+  for (Miss &miss : heavyHitters) {
+    if (miss.keyword.compare(0, string::npos, keyword, length) == 0) {
+      miss.estimate = std::max(miss.estimate, estimate);
+      return;
+    }
+  }
+
+  if (heavyHitters.size() < TOP_K) {
+    heavyHitters.push_back(Miss{string(keyword, length), estimate});
+    return;
+  }
+
+  vector<Miss>::iterator leastMissed = std::min_element(
+      heavyHitters.begin(), heavyHitters.end(),
+      [](const Miss &m1, const Miss &m2) { return m1.estimate < m2.estimate; });
+  if (estimate > leastMissed->estimate) {
+    *leastMissed = Miss{string(keyword, length), estimate};
+  }
+
+  leastMissed = std::min_element(
+      heavyHitters.begin(), heavyHitters.end(),
+      [](const Miss &m1, const Miss &m2) { return m1.estimate < m2.estimate; });
+  admissionEstimate.store(leastMissed->estimate + 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the counter a hash maps to in a row of the sketch,
+ *        using double hashing on the hash's two halves.
+ */
+size_t MissSketch::columnOf(uint64_t hash, int row) {
+  uint64_t h1 = hash & 0xffffffffULL;
+  uint64_t h2 = (hash >> 32) | 1;
+  return (h1 + row * h2) % WIDTH;
+}
+
+/** ---END:------ HEAVY HITTER HELPER METHODS ------------------------- */
@@ -0,0 +1,60 @@
+/**
+ * File:        MissSketch.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  that count how often keywords that are NOT in a dictionary
+ *  were searched for, using a fixed amount of memory.
+ */
+
+#ifndef MISSSKETCH_H
+#define MISSSKETCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   A count-min sketch of missed keywords that also keeps the
+ *          most missed ones (heavy hitters). Counting is lock-free; the
+ *          heavy-hitter list is only locked when a keyword's estimate
+ *          is high enough to enter it.
+ */
+class MissSketch {
+public:
+  struct Miss {
+    std::string keyword;
+    std::uint32_t estimate;
+  };
+
+  MissSketch();
+
+  void record(const char *keyword, std::size_t length);
+  std::uint32_t estimate(const char *keyword, std::size_t length) const;
+  std::uint64_t totalMisses() const;
+  std::vector<Miss> topMisses() const;
+
+private:
+  static const int DEPTH = 4;
+  static const int WIDTH = 2048;
+  static const std::size_t TOP_K = 10;
+
+  std::atomic<std::uint32_t> counters[DEPTH][WIDTH];
+  std::atomic<std::uint64_t> misses;
+  std::atomic<std::uint32_t> admissionEstimate;
+
+  mutable std::mutex heavyHittersMutex;
+  std::vector<Miss> heavyHitters;
+
+  void admit(const char *keyword, std::size_t length, std::uint32_t estimate);
+  static std::size_t columnOf(std::uint64_t hash, int row);
+};
+
+#endif // MISSSKETCH_H
@@ -0,0 +1,72 @@
+/**
+ * File:        SessionLog.cpp
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains implemented methods and properties
+ *  that record the searches of a session to a log, and read them back
+ *  so that they can be replayed.
+ */
+
+#include "SessionLog.h"
+
+#include <cstdlib>
+
+using std::ifstream;
+using std::string;
+using std::uint64_t;
+using std::vector;
+using std::chrono::steady_clock;
+
+bool SessionRecorder::open(const string &path) {
+  log.open(path, std::ios::out | std::ios::app);
+  return log.is_open();
+}
+
+bool SessionRecorder::isOpen() const { return log.is_open(); }
+
+/**
+ * @brief Appends a search to the log. The first search of a session is
+ *        logged with no delay.
+ */
+void SessionRecorder::record(const AccountedString &searchQuery) {
+  steady_clock::time_point now = steady_clock::now();
+  uint64_t delayMicroseconds =
+      hasRecorded ? std::chrono::duration_cast<std::chrono::microseconds>(
+                        now - previousSearch)
+                        .count()
+                  : 0;
+  previousSearch = now;
+  hasRecorded = true;
+
+  log << delayMicroseconds << '\t';
+  log.write(searchQuery.data(), searchQuery.size());
+  log << '\n';
+  log.flush();
+}
+
+/**
+ * @brief Reads the searches of a session log. Returns false if the log
+ *        could not be opened.
+ */
+bool loadSessionLog(const string &path, vector<RecordedQuery> &queries) {
+  ifstream log(path);
+  if (!log.is_open()) {
+    return false;
+  }
+
+  string line;
+  while (getline(log, line)) {
+    size_t tab = line.find('\t');
+    if (tab == string::npos) {
+      continue;
+    }
+    queries.push_back(RecordedQuery{
+        std::strtoull(line.substr(0, tab).c_str(), nullptr, 10),
+        line.substr(tab + 1)});
+  }
+  return true;
+}
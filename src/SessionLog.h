@@ -0,0 +1,54 @@
+/**
+ * File:        SessionLog.h
+ *
+ * Author:      Mandy Noto
+ * Semester:    Fall 2021
+ * Course:      CSC340
+ *
+ * Summary of File:
+ *  This file contains to-be-implemented methods and properties
+ *  that record the searches of a session to a log, and read them back
+ *  so that they can be replayed.
+ */
+
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MemoryAccounting.h"
+
+/**
+ * @brief   A search read back from a session log, with the microseconds
+ *          that passed since the search before it.
+ */
+struct RecordedQuery {
+  std::uint64_t delayMicroseconds;
+  std::string searchQuery;
+};
+
+/**
+ * @brief   Writes every search of a session as one line of a log:
+ *              <microseconds since the previous search> TAB <search>
+ */
+class SessionRecorder {
+public:
+  bool open(const std::string &path);
+  bool isOpen() const;
+
+  void record(const AccountedString &searchQuery);
+
+private:
+  std::ofstream log;
+  std::chrono::steady_clock::time_point previousSearch;
+  bool hasRecorded{false};
+};
+
+bool loadSessionLog(const std::string &path,
+                    std::vector<RecordedQuery> &queries);
+
+#endif // SESSIONLOG_H